@@ -0,0 +1,273 @@
+/*
+  ==============================================================================
+
+    DisburserBenchmark.cpp
+    Created: 17 Oct 2026 10:12:31am
+    Author:  kylew
+
+    Headless processBlock benchmark. Runs the processor without an editor over
+    a grid of engine, scatter, cutoff/smash, block size, sample rate, oversampling
+    and sample precision, and prints the results as JSON. On the extended engine
+    scatter is the Extended Scatter parameter.
+
+    Usage: DisburserBenchmark [--full] [--seconds=<s>] [--output=<file>] [--fail-on-violation]
+
+    By default it runs a small grid that covers every axis in a few minutes.
+    --full runs every combination, a few thousand cases that take hours.
+
+    Built with -DDISBURSER_RT_SANITIZER=ON, every case also counts allocations
+    and locks inside processBlock, and --fail-on-violation exits with 1 if any
+    case had one.
+
+  ==============================================================================
+*/
+
+#include <iostream>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "../PluginProcessor.h"
+#include "../Utility/RealtimeSanitizer.h"
+
+namespace
+{
+    struct BenchmarkCase
+    {
+        int engine; //choice index, 0 cascade, 1 extended
+        float scatter;
+        float cutoff;
+        float smash;
+        int blockSize;
+        double sampleRate;
+        int oversampling; //choice index, 0 off, 1 2x, 2 4x
+        bool doublePrecision;
+    };
+
+    struct BenchmarkSettings
+    {
+        double secondsPerCase = 2.0;
+        bool full = false;
+        bool failOnViolation = false;
+        juce::File outputFile;
+    };
+
+    BenchmarkSettings parseArguments(int argc, char* argv[])
+    {
+        BenchmarkSettings settings;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            auto arg = juce::String(argv[i]);
+
+            if (arg == "--full")
+                settings.full = true;
+            else if (arg == "--quick") //the default, still accepted
+                settings.full = false;
+            else if (arg.startsWith("--seconds="))
+                settings.secondsPerCase = juce::jmax(0.05, arg.fromFirstOccurrenceOf("=", false, false).getDoubleValue());
+            else if (arg == "--fail-on-violation")
+                settings.failOnViolation = true;
+            else if (arg.startsWith("--output="))
+                settings.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(arg.fromFirstOccurrenceOf("=", false, false));
+        }
+
+        return settings;
+    }
+
+    std::vector<BenchmarkCase> makeGrid(bool full)
+    {
+        std::vector<float> scatters{ 0, 2, 8, 16, 32, 64 };
+        std::vector<float> extendedScatters{ 128, 512, 1024, 4096 };
+        std::vector<std::pair<float, float>> cutoffSmash{ { 200.f, .71f }, { 2000.f, 5.f }, { 12000.f, 10.f } };
+        std::vector<int> blockSizes{ 16, 64, 256, 1024, 4096 };
+        std::vector<double> sampleRates{ 44100.0, 48000.0, 96000.0, 192000.0 };
+        std::vector<int> oversamplings{ 0, 1, 2 };
+        std::vector<bool> precisions{ false, true };
+
+        if (!full)
+        {
+            scatters = { 0, 64 };
+            extendedScatters = { 512, 4096 };
+            cutoffSmash = { { 200.f, .71f } };
+            blockSizes = { 64, 512 };
+            sampleRates = { 48000.0, 192000.0 };
+            oversamplings = { 0, 2 };
+        }
+
+        std::vector<BenchmarkCase> grid;
+
+        for (auto dp : precisions)
+            for (auto os : oversamplings)
+                for (auto sr : sampleRates)
+                    for (auto bs : blockSizes)
+                        for (auto& cs : cutoffSmash)
+                        {
+                            for (auto sc : scatters)
+                                grid.push_back({ 0, sc, cs.first, cs.second, bs, sr, os, dp });
+
+                            for (auto sc : extendedScatters)
+                                grid.push_back({ 1, sc, cs.first, cs.second, bs, sr, os, dp });
+                        }
+
+        return grid;
+    }
+
+    void setParameter(DisburserAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* param = processor.apvts.getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        auto index = (size_t)juce::roundToInt(p / 100.0 * (double)(sorted.size() - 1));
+        return sorted[index];
+    }
+
+    template <typename SampleType>
+    juce::var runCase(const BenchmarkCase& c, double secondsPerCase)
+    {
+        DisburserAudioProcessor processor;
+        processor.setPlayConfigDetails(2, 2, c.sampleRate, c.blockSize);
+        processor.setProcessingPrecision(std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                              : juce::AudioProcessor::singlePrecision);
+
+        setParameter(processor, "engine", (float)c.engine);
+        setParameter(processor, c.engine == 1 ? "extendedScatter" : "scatter", c.scatter);
+        setParameter(processor, "cutoff", c.cutoff);
+        setParameter(processor, "smash", c.smash);
+        setParameter(processor, "oversampling", (float)c.oversampling);
+
+        processor.prepareToPlay(c.sampleRate, c.blockSize);
+
+        //The extended engine renders its response on a worker, so give that time to land
+        //before the warmup rather than timing a convolution with nothing loaded
+        auto deadline = juce::Time::getMillisecondCounter() + 5000;
+
+        while (!processor.isExtendedReady() && juce::Time::getMillisecondCounter() < deadline)
+            juce::Thread::sleep(5);
+
+        auto violationsBefore = RealtimeSanitizer::getNumViolations();
+
+        juce::AudioBuffer<SampleType> buffer(2, c.blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(0x5eed);
+
+        auto fillNoise = [&]()
+            {
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                {
+                    auto* data = buffer.getWritePointer(ch);
+
+                    for (int s = 0; s < buffer.getNumSamples(); ++s)
+                        data[s] = (SampleType)(random.nextFloat() * .5f - .25f);
+                }
+            };
+
+        //Let parameter smoothing and stage crossfades settle before measuring
+        auto warmupBlocks = juce::jmax(64, (int)(c.sampleRate * .25 / c.blockSize));
+        for (int i = 0; i < warmupBlocks; ++i)
+        {
+            fillNoise();
+            processor.processBlock(buffer, midi);
+        }
+
+        auto numBlocks = juce::jmax(16, (int)(c.sampleRate * secondsPerCase / c.blockSize));
+
+        std::vector<double> blockNs;
+        blockNs.reserve((size_t)numBlocks);
+
+        auto ticksToNs = 1.0e9 / (double)juce::Time::getHighResolutionTicksPerSecond();
+        double totalNs = 0.0;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            fillNoise();
+
+            auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            auto end = juce::Time::getHighResolutionTicks();
+
+            auto ns = (double)(end - start) * ticksToNs;
+            blockNs.push_back(ns);
+            totalNs += ns;
+        }
+
+        auto violations = RealtimeSanitizer::getNumViolations() - violationsBefore;
+        auto meter = processor.loadMeter.getStats();
+
+        processor.releaseResources();
+
+        std::sort(blockNs.begin(), blockNs.end());
+
+        auto totalSamples = (double)numBlocks * c.blockSize;
+        auto audioNs = totalSamples / c.sampleRate * 1.0e9;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("engine", c.engine == 1 ? "extended" : "cascade");
+        result->setProperty("scatter", c.scatter);
+        result->setProperty("cutoff", c.cutoff);
+        result->setProperty("smash", c.smash);
+        result->setProperty("blockSize", c.blockSize);
+        result->setProperty("sampleRate", c.sampleRate);
+        result->setProperty("oversampling", 1 << c.oversampling);
+        result->setProperty("precision", c.doublePrecision ? "double" : "float");
+        result->setProperty("latencySamples", processor.getLatencySamples());
+        result->setProperty("blocks", numBlocks);
+        result->setProperty("nsPerSample", totalNs / totalSamples);
+        result->setProperty("blockNsMin", blockNs.front());
+        result->setProperty("blockNsP50", percentile(blockNs, 50.0));
+        result->setProperty("blockNsP90", percentile(blockNs, 90.0));
+        result->setProperty("blockNsP99", percentile(blockNs, 99.0));
+        result->setProperty("blockNsMax", blockNs.back());
+        result->setProperty("realtimeFactor", totalNs > 0.0 ? audioNs / totalNs : 0.0);
+
+        //The plugin's own meter, over its last DspLoadMeter::windowSize blocks
+        result->setProperty("meterLoadMean", meter.mean);
+        result->setProperty("meterLoadP99", meter.p99);
+        result->setProperty("meterLoadMax", meter.max);
+
+        if (RealtimeSanitizer::isEnabled())
+            result->setProperty("realtimeViolations", violations);
+
+        return juce::var(result);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto settings = parseArguments(argc, argv);
+    auto grid = makeGrid(settings.full);
+
+    juce::Array<juce::var> results;
+
+    for (auto& c : grid)
+        results.add(c.doublePrecision ? runCase<double>(c, settings.secondsPerCase)
+                                      : runCase<float>(c, settings.secondsPerCase));
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("plugin", "Disburser");
+    root->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("secondsPerCase", settings.secondsPerCase);
+    root->setProperty("realtimeSanitizer", RealtimeSanitizer::isEnabled());
+    root->setProperty("results", results);
+
+    auto json = juce::JSON::toString(juce::var(root));
+
+    if (settings.outputFile != juce::File())
+        settings.outputFile.replaceWithText(json);
+
+    std::cout << json << std::endl;
+
+    if (settings.failOnViolation && RealtimeSanitizer::getNumViolations() > 0)
+    {
+        std::cerr << RealtimeSanitizer::getNumViolations() << " realtime violations in processBlock" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
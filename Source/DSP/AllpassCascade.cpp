@@ -0,0 +1,347 @@
+/*
+  ==============================================================================
+
+    AllpassCascade.cpp
+    Created: 17 Oct 2026 11:03:52am
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "AllpassCascade.h"
+
+AllpassCoefficients AllpassCoefficients::make(double sampleRate, float frequency, float q)
+{
+    //Keep the prewarp away from Nyquist, tan() blows up past it
+    auto freq = juce::jlimit(1.0, sampleRate * .49, (double)frequency);
+
+    auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / (double)q;
+    auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    AllpassCoefficients coefs;
+    coefs.b0 = c1 * (1.0 - n * invQ + nSquared);
+    coefs.b1 = c1 * 2.0 * (1.0 - nSquared);
+
+    return coefs;
+}
+
+template <typename SampleType>
+AllpassCascade<SampleType>::AllpassCascade()
+{
+    reset();
+}
+
+template <typename SampleType>
+AllpassCascade<SampleType>::~AllpassCascade()
+{
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::prepare(double sampleRate, int maximumBlockSize)
+{
+    auto size = (size_t)juce::jmax(1, maximumBlockSize);
+    block.assign(size, Register::expand(SampleType(0)));
+    tap.assign(size, Register::expand(SampleType(0)));
+
+    setSampleRate(sampleRate);
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::setSampleRate(double sampleRate)
+{
+    fadeLength = juce::jmax(1, juce::roundToInt(sampleRate * fadeSeconds));
+    fadeRemaining = 0;
+
+    reset();
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::reset()
+{
+    for (int i = 0; i < maxStages; i++)
+    {
+        state1[i] = Register::expand(SampleType(0));
+        state2[i] = Register::expand(SampleType(0));
+    }
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::setCoefficients(const AllpassCoefficients& coefs, int rampSamples)
+{
+    target = { (SampleType)coefs.b0, (SampleType)coefs.b1 };
+
+    if (rampSamples <= 0)
+    {
+        current = target;
+        delta = {};
+        rampRemaining = 0;
+        return;
+    }
+
+    delta.b0 = (target.b0 - current.b0) / (SampleType)rampSamples;
+    delta.b1 = (target.b1 - current.b1) / (SampleType)rampSamples;
+    rampRemaining = rampSamples;
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::setNumStages(int numStages)
+{
+    currentStages = juce::jlimit(0, (int)maxStages, numStages);
+    fadeRemaining = 0;
+
+    //Stages past the new count go back to rest, so they can't hold isSilent false
+    for (int i = currentStages; i < maxStages; i++)
+    {
+        state1[i] = Register::expand(SampleType(0));
+        state2[i] = Register::expand(SampleType(0));
+    }
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::process(SampleType* const* channels, int numChannels, int numSamples, int numStages)
+{
+    numStages = juce::jlimit(0, (int)maxStages, numStages);
+    numChannels = juce::jlimit(0, (int)numLanes, numChannels);
+
+    if (block.empty())
+        return;
+
+    auto chunkSize = (int)block.size();
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize)
+    {
+        auto num = juce::jmin(chunkSize, numSamples - offset);
+        processChunk(channels, numChannels, offset, num, numStages);
+    }
+}
+
+template <typename SampleType>
+bool AllpassCascade<SampleType>::isSilent(SampleType threshold) const
+{
+    auto peak = Register::expand(SampleType(0));
+
+    for (int i = 0; i < maxStages; i++)
+        peak = Register::max(peak, Register::max(Register::abs(state1[i]), Register::abs(state2[i])));
+
+    for (size_t lane = 0; lane < (size_t)numLanes; lane++)
+        if (peak.get(lane) > threshold)
+            return false;
+
+    return true;
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::processChunk(SampleType* const* channels, int numChannels, int offset, int numSamples, int numStages)
+{
+    //A change that arrives mid-fade waits for the current fade to finish
+    if (fadeRemaining == 0 && numStages != currentStages)
+    {
+        fromStages = currentStages;
+        toStages = numStages;
+        fadeRemaining = fadeLength;
+
+        //Stages coming in start from rest rather than whatever they held last time
+        for (int i = fromStages; i < toStages; i++)
+        {
+            state1[i] = Register::expand(SampleType(0));
+            state2[i] = Register::expand(SampleType(0));
+        }
+    }
+
+    if (fadeRemaining == 0 && currentStages == 0)
+    {
+        advanceRamp(juce::jmin(rampRemaining, numSamples));
+        return;
+    }
+
+    //Unused lanes stay at zero, and zero in gives zero out
+    auto* lanes = reinterpret_cast<SampleType*>(block.data());
+
+    for (int c = 0; c < numChannels; c++)
+    {
+        auto* channel = channels[c] + offset;
+
+        for (int s = 0; s < numSamples; s++)
+            lanes[s * numLanes + c] = channel[s];
+    }
+
+    auto rampSamples = juce::jmin(rampRemaining, numSamples);
+
+    if (fadeRemaining > 0)
+    {
+        auto lower = juce::jmin(fromStages, toStages);
+        auto upper = juce::jmax(fromStages, toStages);
+
+        runStages(block.data(), numSamples, rampSamples, 0, lower);
+        std::copy(block.begin(), block.begin() + numSamples, tap.begin());
+        runStages(block.data(), numSamples, rampSamples, lower, upper);
+
+        mixTransition(numSamples);
+    }
+    else
+    {
+        runStages(block.data(), numSamples, rampSamples, 0, currentStages);
+    }
+
+    advanceRamp(rampSamples);
+
+    for (int c = 0; c < numChannels; c++)
+    {
+        auto* channel = channels[c] + offset;
+
+        for (int s = 0; s < numSamples; s++)
+            channel[s] = lanes[s * numLanes + c];
+    }
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::runStages(Register* data, int numSamples, int rampSamples, int firstStage, int lastStage)
+{
+    if (lastStage > firstStage)
+        (this->*kernels[(size_t)(lastStage - firstStage)])(data, numSamples, rampSamples, firstStage);
+}
+
+template <typename SampleType>
+template <int numStages>
+void AllpassCascade<SampleType>::runKernel(Register* data, int numSamples, int rampSamples, int firstStage)
+{
+    //Peels off whole groups first, so 13 stages run as 4 + 4 + 4 + 1
+    if constexpr (numStages > 0)
+    {
+        constexpr int numFused = numStages < (int)fuseWidth ? numStages : (int)fuseWidth;
+
+        runFused<numFused>(data, numSamples, rampSamples, firstStage);
+        runKernel<numStages - numFused>(data, numSamples, rampSamples, firstStage + numFused);
+    }
+}
+
+template <typename SampleType>
+template <int numFused>
+void AllpassCascade<SampleType>::runFused(Register* data, int numSamples, int rampSamples, int firstStage)
+{
+    Register s1[numFused], s2[numFused];
+
+    for (int i = 0; i < numFused; i++)
+    {
+        s1[i] = state1[firstStage + i];
+        s2[i] = state2[firstStage + i];
+    }
+
+    //Every stage shares one design, so a ramp steps the coefficients once per sample for the whole group
+    auto c0 = Register::expand(current.b0);
+    auto c1 = Register::expand(current.b1);
+    auto db0 = Register::expand(delta.b0);
+    auto db1 = Register::expand(delta.b1);
+
+    for (int s = 0; s < rampSamples; s++)
+    {
+        auto x = data[s];
+
+        //Transposed direct form II, same recursion as juce::dsp::IIR::Filter
+        for (int i = 0; i < numFused; i++)
+        {
+            auto y = c0 * x + s1[i];
+            s1[i] = c1 * (x - y) + s2[i];
+            s2[i] = x - c0 * y;
+            x = y;
+        }
+
+        data[s] = x;
+
+        c0 += db0;
+        c1 += db1;
+    }
+
+    auto t0 = Register::expand(target.b0);
+    auto t1 = Register::expand(target.b1);
+
+    for (int s = rampSamples; s < numSamples; s++)
+    {
+        auto x = data[s];
+
+        for (int i = 0; i < numFused; i++)
+        {
+            auto y = t0 * x + s1[i];
+            s1[i] = t1 * (x - y) + s2[i];
+            s2[i] = x - t0 * y;
+            x = y;
+        }
+
+        data[s] = x;
+    }
+
+    for (int i = 0; i < numFused; i++)
+    {
+        state1[firstStage + i] = s1[i];
+        state2[firstStage + i] = s2[i];
+    }
+}
+
+template <typename SampleType>
+template <size_t... counts>
+constexpr std::array<typename AllpassCascade<SampleType>::Kernel, sizeof...(counts)> AllpassCascade<SampleType>::makeKernels(std::index_sequence<counts...>)
+{
+    return { &AllpassCascade::runKernel<(int)counts>... };
+}
+
+template <typename SampleType>
+const std::array<typename AllpassCascade<SampleType>::Kernel, AllpassCascade<SampleType>::maxStages + 1> AllpassCascade<SampleType>::kernels
+    = AllpassCascade<SampleType>::makeKernels(std::make_index_sequence<AllpassCascade<SampleType>::maxStages + 1>());
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::advanceRamp(int numSamples)
+{
+    if (rampRemaining == 0)
+        return;
+
+    rampRemaining -= numSamples;
+
+    if (rampRemaining <= 0)
+    {
+        current = target;
+        delta = {};
+        rampRemaining = 0;
+        return;
+    }
+
+    current.b0 += delta.b0 * (SampleType)numSamples;
+    current.b1 += delta.b1 * (SampleType)numSamples;
+}
+
+template <typename SampleType>
+void AllpassCascade<SampleType>::mixTransition(int numSamples)
+{
+    //block holds the longer cascade, tap the shorter one
+    auto* longer = block.data();
+    auto* shorter = tap.data();
+    auto growing = toStages > fromStages;
+    auto step = SampleType(1) / (SampleType)fadeLength;
+
+    for (int s = 0; s < numSamples; s++)
+    {
+        auto done = fadeRemaining > 0 ? (SampleType)(fadeLength - fadeRemaining) * step : SampleType(1);
+        auto gain = Register::expand(growing ? done : SampleType(1) - done);
+
+        longer[s] = shorter[s] + (longer[s] - shorter[s]) * gain;
+
+        if (fadeRemaining > 0)
+            --fadeRemaining;
+    }
+
+    if (fadeRemaining == 0)
+    {
+        //Stages faded out go back to rest, otherwise whatever they held keeps isSilent false
+        for (int i = toStages; i < fromStages; i++)
+        {
+            state1[i] = Register::expand(SampleType(0));
+            state2[i] = Register::expand(SampleType(0));
+        }
+
+        currentStages = toStages;
+    }
+}
+
+template struct AllpassCascade<float>;
+template struct AllpassCascade<double>;
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    AllpassCascade.h
+    Created: 17 Oct 2026 11:03:52am
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+
+//Same design as juce::dsp::IIR::Coefficients<float>::makeAllPass, but written into
+//plain values so it can run on the audio thread without allocating.
+//makeAllPass gives b2 == a0 == 1, a1 == b1 and a2 == b0, so two values describe a stage.
+//The design is kept in double, each cascade rounds it to its own sample type.
+struct AllpassCoefficients
+{
+    double b0 = 0.0;
+    double b1 = 0.0;
+
+    static AllpassCoefficients make(double sampleRate, float frequency, float q);
+
+    bool operator== (const AllpassCoefficients& other) const { return b0 == other.b0 && b1 == other.b1; }
+    bool operator!= (const AllpassCoefficients& other) const { return !(*this == other); }
+};
+
+//Runs the dispersion allpasses for up to numLanes channels together. Lane n of
+//each register holds channel n's biquad state, so a group of four channels (eight
+//with AVX) costs the same as one. Wider layouts use one cascade per group.
+//
+//Blocks are processed a few stages at a time: the audio is interleaved into a
+//register per sample, then each group of up to fuseWidth stages runs over the
+//whole block with its coefficients and state held in registers. Every stage
+//count from 0 to maxStages has its own kernel, unrolled at compile time into
+//those groups and picked from a table, so the sample loop has no stage loop,
+//branches or lookups inside it.
+//
+//When the stage count changes the cascade runs up to the larger of the two
+//counts, taps the output at both and crossfades between them over a fixed
+//time. A longer cascade is just the shorter one with more stages on the end,
+//so a transition never costs more than maxStages plus one copy and one mix.
+//
+//Coefficient changes can be ramped: every stage shares one design, so the
+//cascade steps b0 and b1 linearly from the current design to the new one over
+//the next rampSamples, at the cost of two adds per stage and sample.
+//Both designs lie inside the biquad stability triangle, which is convex, so
+//every point on the ramp is a stable allpass too.
+//
+//SampleType is float or double. Doubles halve the lanes per register, but high Q
+//stages at low cutoffs keep a much lower noise floor through a long cascade.
+template <typename SampleType>
+struct AllpassCascade
+{
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+
+    enum
+    {
+        maxStages = 32, //per channel, scatter 64 == 32 stages on each channel
+        numLanes = (int)Register::SIMDNumElements,
+
+        //Stages per pass over the block. Four keep eight state registers, the sample
+        //and the coefficients inside the sixteen vector registers of SSE and NEON.
+        fuseWidth = 4
+    };
+
+    AllpassCascade();
+    ~AllpassCascade();
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void setSampleRate(double sampleRate); //for a rate change without reallocating, clears the state
+    void reset();
+    void setCoefficients(const AllpassCoefficients& coefs, int rampSamples = 0);
+    void setNumStages(int numStages); //jumps straight there, no crossfade
+    void process(SampleType* const* channels, int numChannels, int numSamples, int numStages); //numChannels <= numLanes
+
+    //True when no stage holds more than threshold, so silence in gives silence out
+    bool isSilent(SampleType threshold) const;
+
+private:
+    struct Coefficients
+    {
+        SampleType b0{}, b1{};
+    };
+
+    void processChunk(SampleType* const* channels, int numChannels, int offset, int numSamples, int numStages);
+    void runStages(Register* data, int numSamples, int rampSamples, int firstStage, int lastStage);
+
+    using Kernel = void (AllpassCascade::*)(Register* data, int numSamples, int rampSamples, int firstStage);
+
+    template <int numStages>
+    void runKernel(Register* data, int numSamples, int rampSamples, int firstStage);
+    template <int numFused>
+    void runFused(Register* data, int numSamples, int rampSamples, int firstStage);
+    template <size_t... counts>
+    static constexpr std::array<Kernel, sizeof...(counts)> makeKernels(std::index_sequence<counts...>);
+
+    //Indexed by stage count
+    static const std::array<Kernel, maxStages + 1> kernels;
+    void advanceRamp(int numSamples);
+    void mixTransition(int numSamples);
+
+    Coefficients current, target, delta;
+    int rampRemaining{ 0 };
+
+    std::array<Register, maxStages> state1, state2;
+
+    std::vector<Register> block, tap;
+
+    static constexpr double fadeSeconds = .05;
+    int fadeLength{ 1 };
+    int fadeRemaining{ 0 };
+    int currentStages{ 0 };
+    int fromStages{ 0 }, toStages{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AllpassCascade)
+};
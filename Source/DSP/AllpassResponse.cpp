@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    AllpassResponse.cpp
+    Created: 17 Oct 2026 3:41:07pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "AllpassResponse.h"
+
+AllpassResponse::AllpassResponse()
+{
+}
+
+AllpassResponse::~AllpassResponse()
+{
+}
+
+void AllpassResponse::prepare(double sr, int numPoints, float minFrequency, float maxFrequency)
+{
+    sampleRate = sr;
+
+    auto size = (size_t)juce::jmax(2, numPoints);
+
+    for (auto* v : { &frequencies, &groupDelayMs, &phase, &omega, &cos1, &sin1, &cos2, &sin2, &aRe, &aIm })
+        v->assign(size, 0.f);
+
+    auto top = juce::jmin((double)maxFrequency, sampleRate * .5);
+    auto ratio = std::log(top / minFrequency);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        auto f = minFrequency * std::exp(ratio * (double)i / (double)(size - 1));
+        auto w = juce::MathConstants<double>::twoPi * f / sampleRate;
+
+        frequencies[i] = (float)f;
+        omega[i] = (float)w;
+        cos1[i] = (float)std::cos(w);
+        sin1[i] = (float)std::sin(w);
+        cos2[i] = (float)std::cos(2.0 * w);
+        sin2[i] = (float)std::sin(2.0 * w);
+    }
+}
+
+void AllpassResponse::compute(const AllpassCoefficients& coefs, int numStages)
+{
+    auto size = frequencies.size();
+    auto b0 = (float)coefs.b0;
+    auto b1 = (float)coefs.b1;
+    auto stages = (float)numStages;
+    auto toMs = sampleRate > 0.0 ? (float)(1000.0 / sampleRate) : 0.f;
+
+    //A = 1 + b1 e^-jw + b0 e^-2jw
+    for (size_t i = 0; i < size; i++)
+    {
+        aRe[i] = 1.f + b1 * cos1[i] + b0 * cos2[i];
+        aIm[i] = -(b1 * sin1[i] + b0 * sin2[i]);
+    }
+
+    //Re(B / A) with B = b1 e^-jw + 2 b0 e^-2jw
+    for (size_t i = 0; i < size; i++)
+    {
+        auto bRe = b1 * cos1[i] + 2.f * b0 * cos2[i];
+        auto bIm = -(b1 * sin1[i] + 2.f * b0 * sin2[i]);
+        auto mag = aRe[i] * aRe[i] + aIm[i] * aIm[i];
+        auto ratio = (bRe * aRe[i] + bIm * aIm[i]) / juce::jmax(mag, 1.0e-20f);
+
+        groupDelayMs[i] = stages * (2.f - 2.f * ratio) * toMs;
+    }
+
+    //A is minimum phase, so its angle never wraps and atan2 gives the unwrapped phase directly
+    for (size_t i = 0; i < size; i++)
+        phase[i] = -stages * (2.f * omega[i] + 2.f * std::atan2(aIm[i], aRe[i]));
+}
+
+float AllpassResponse::getStageGroupDelay(const AllpassCoefficients& coefs, double w)
+{
+    auto c1 = std::cos(w), s1 = std::sin(w);
+    auto c2 = std::cos(2.0 * w), s2 = std::sin(2.0 * w);
+
+    auto aRe = 1.0 + coefs.b1 * c1 + coefs.b0 * c2;
+    auto aIm = -(coefs.b1 * s1 + coefs.b0 * s2);
+    auto bRe = coefs.b1 * c1 + 2.0 * coefs.b0 * c2;
+    auto bIm = -(coefs.b1 * s1 + 2.0 * coefs.b0 * s2);
+
+    auto mag = juce::jmax(aRe * aRe + aIm * aIm, 1.0e-20);
+
+    return (float)(2.0 - 2.0 * (bRe * aRe + bIm * aIm) / mag);
+}
+
+double AllpassResponse::getPeakStageGroupDelay(const AllpassCoefficients& coefs, double maxOmega)
+{
+    constexpr int numPoints = 512;
+    double peak = 0.0;
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto w = maxOmega * std::pow(1.0e-4, 1.0 - (double)i / (double)(numPoints - 1));
+        peak = juce::jmax(peak, (double)getStageGroupDelay(coefs, w));
+    }
+
+    return peak;
+}
+
+double AllpassResponse::getDecaySamples(const AllpassCoefficients& coefs, double threshold)
+{
+    //Poles are the roots of z^2 + b1 z + b0, a complex pair sits at radius sqrt(b0)
+    auto discriminant = coefs.b1 * coefs.b1 - 4.0 * coefs.b0;
+    double radius;
+
+    if (discriminant < 0.0)
+    {
+        radius = std::sqrt(coefs.b0);
+    }
+    else
+    {
+        auto root = std::sqrt(discriminant);
+        radius = juce::jmax(std::abs(-coefs.b1 + root), std::abs(-coefs.b1 - root)) * .5;
+    }
+
+    if (radius <= 0.0)
+        return 0.0;
+
+    if (radius >= 1.0)
+        return std::numeric_limits<double>::max();
+
+    return std::log(threshold) / std::log(radius);
+}
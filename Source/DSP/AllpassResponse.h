@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    AllpassResponse.h
+    Created: 17 Oct 2026 3:41:07pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "AllpassCascade.h"
+
+//Analytic phase and group delay of the dispersion cascade on a log frequency grid.
+//
+//With A(w) = 1 + b1 e^-jw + b0 e^-2jw, one stage is H = e^-2jw conj(A) / A, so
+//    phase(H) = -2w - 2 arg(A)
+//    delay(H) = 2 - 2 Re(B / A),   B(w) = b1 e^-jw + 2 b0 e^-2jw
+//and the cascade is that times the number of stages per channel. The trig for
+//the grid is tabled once per sample rate, so an update is a few passes of
+//multiplies and adds over flat arrays.
+struct AllpassResponse
+{
+    AllpassResponse();
+    ~AllpassResponse();
+
+    void prepare(double sampleRate, int numPoints, float minFrequency, float maxFrequency);
+    void compute(const AllpassCoefficients& coefs, int numStages);
+
+    int getNumPoints() const { return (int)frequencies.size(); }
+    double getSampleRate() const { return sampleRate; }
+
+    //Group delay of a single stage in samples, at w = 2 pi f / sampleRate
+    static float getStageGroupDelay(const AllpassCoefficients& coefs, double omega);
+
+    //Largest single stage group delay in samples between DC and maxOmega, on a log grid
+    static double getPeakStageGroupDelay(const AllpassCoefficients& coefs, double maxOmega);
+
+    //Samples for the slowest pole to ring down to threshold on its own
+    static double getDecaySamples(const AllpassCoefficients& coefs, double threshold);
+
+    std::vector<float> frequencies;
+    std::vector<float> groupDelayMs;
+    std::vector<float> phase; //unwrapped, radians
+
+private:
+    double sampleRate{ 0.0 };
+    std::vector<float> omega, cos1, sin1, cos2, sin2;
+    std::vector<float> aRe, aIm;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AllpassResponse)
+};
@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+    ExtendedDispersion.cpp
+    Created: 17 Oct 2026 7:12:44pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "ExtendedDispersion.h"
+#include "AllpassResponse.h"
+
+namespace
+{
+    //Responses are sized to the peak delay and half as long again for the ringing after it
+    constexpr double ringFactor = 1.5;
+    constexpr int ringPadding = 2048;
+}
+
+ImpulseThread::ImpulseThread()
+    : juce::TimeSliceThread("Disburser Impulse")
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+ImpulseThread::~ImpulseThread()
+{
+    stopThread(1000);
+}
+
+ExtendedDispersion::ExtendedDispersion()
+{
+}
+
+ExtendedDispersion::~ExtendedDispersion()
+{
+    setActive(false);
+}
+
+void ExtendedDispersion::prepare(double newSampleRate, int maximumBlockSize, int numChannels)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+    preparedChannels = juce::jmax(1, numChannels);
+
+    if (!active)
+        return;
+
+    //Keep the worker off the engines while they're rebuilt
+    (*impulseThread)->removeTimeSliceClient(this);
+
+    auto engines = makeEngines();
+    swapEngines(engines);
+
+    rendered = {};
+    tailSamples = 0;
+
+    (*impulseThread)->addTimeSliceClient(this);
+}
+
+void ExtendedDispersion::setActive(bool shouldBeActive)
+{
+    if (shouldBeActive == active)
+        return;
+
+    if (shouldBeActive)
+    {
+        impulseThread = std::make_unique<juce::SharedResourcePointer<ImpulseThread>>();
+
+        auto engines = makeEngines();
+        swapEngines(engines);
+
+        rendered = {};
+        tailSamples = 0;
+        active = true;
+
+        (*impulseThread)->addTimeSliceClient(this);
+    }
+    else
+    {
+        active = false;
+
+        //Waits out a render in progress, after this the worker never touches the engines again
+        (*impulseThread)->removeTimeSliceClient(this);
+
+        Engines none;
+        swapEngines(none);
+
+        impulseThread.reset();
+    }
+}
+
+ExtendedDispersion::Engines ExtendedDispersion::makeEngines() const
+{
+    Engines engines;
+
+    if (sampleRate <= 0.0)
+        return engines;
+
+    auto numEngines = (preparedChannels + 1) / 2;
+
+    for (int i = 0; i < numEngines; ++i)
+    {
+        auto channelsHere = juce::jmin(2, preparedChannels - i * 2);
+
+        engines.push_back(std::make_unique<juce::dsp::Convolution>((*impulseThread)->convolutionQueue));
+        engines.back()->prepare({ sampleRate, (juce::uint32)maxBlockSize, (juce::uint32)channelsHere });
+    }
+
+    return engines;
+}
+
+void ExtendedDispersion::swapEngines(Engines& newEngines)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(engineLock);
+        std::swap(convolutions, newEngines);
+    }
+
+    //The old set is released here on the message thread, outside the lock
+    newEngines.clear();
+}
+
+void ExtendedDispersion::reset()
+{
+    const juce::SpinLock::ScopedTryLockType lock(engineLock);
+
+    if (!lock.isLocked())
+        return;
+
+    for (auto& convolution : convolutions)
+        convolution->reset();
+}
+
+void ExtendedDispersion::setParameters(float cutoff, float q, int numStages, int designFactor)
+{
+    wantedCutoff = cutoff;
+    wantedQ = q;
+    wantedStages = juce::jlimit(0, (int)maxStages, numStages);
+    wantedFactor = juce::jmax(1, designFactor);
+}
+
+void ExtendedDispersion::process(float* const* channels, int numChannels, int numSamples)
+{
+    const juce::SpinLock::ScopedTryLockType lock(engineLock);
+
+    if (!lock.isLocked())
+        return;
+
+    for (size_t i = 0; i < convolutions.size(); ++i)
+    {
+        auto first = (int)i * 2;
+        auto count = juce::jmin(2, numChannels - first);
+
+        if (count <= 0)
+            break;
+
+        juce::dsp::AudioBlock<float> block(channels + first, (size_t)count, (size_t)numSamples);
+        convolutions[i]->process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+}
+
+int ExtendedDispersion::useTimeSlice()
+{
+    Settings wanted;
+    wanted.cutoff = wantedCutoff.load();
+    wanted.q = wantedQ.load();
+    wanted.numStages = wantedStages.load();
+    wanted.designFactor = wantedFactor.load();
+
+    //While a knob is moving this renders at most every 30 ms, the convolution fades between them
+    if (wanted == rendered || sampleRate <= 0.0)
+        return 30;
+
+    rendered = wanted;
+
+    auto coefs = AllpassCoefficients::make(sampleRate * wanted.designFactor, wanted.cutoff, wanted.q);
+
+    auto numStages = getStagesThatFit(coefs, wanted.numStages, wanted.designFactor);
+    auto length = getImpulseLength(coefs, numStages, wanted.designFactor);
+    juce::AudioBuffer<float> impulse(1, length);
+    renderImpulse(coefs, numStages, wanted.designFactor, impulse);
+
+    //Each engine takes ownership of its own copy. No lock needed, the message thread takes
+    //this client off the worker before it swaps the set.
+    for (size_t i = 0; i < convolutions.size(); ++i)
+    {
+        auto copy = i + 1 < convolutions.size() ? juce::AudioBuffer<float>(impulse) : std::move(impulse);
+
+        convolutions[i]->loadImpulseResponse(std::move(copy), sampleRate,
+            juce::dsp::Convolution::Stereo::no, juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+    }
+
+    //The engines may still be fading out of a longer response, so the tail only ever grows here
+    tailSamples = juce::jmax(tailSamples.load(), length);
+
+    return 30;
+}
+
+int ExtendedDispersion::getStagesThatFit(const AllpassCoefficients& coefs, int numStages, int designFactor)
+{
+    //Peak group delay of one stage inside the base band, in samples at the host rate
+    auto peak = AllpassResponse::getPeakStageGroupDelay(coefs, juce::MathConstants<double>::pi / designFactor) / (double)designFactor;
+
+    if (peak <= 0.0)
+        return numStages;
+
+    auto fit = ((double)(1 << maxImpulseOrder) - ringPadding) / ringFactor / peak;
+
+    return fit < (double)numStages ? juce::jmax(0, (int)fit) : numStages;
+}
+
+int ExtendedDispersion::getImpulseLength(const AllpassCoefficients& coefs, int numStages, int designFactor)
+{
+    //Peak group delay inside the base band, in samples at the design rate
+    auto peak = AllpassResponse::getPeakStageGroupDelay(coefs, juce::MathConstants<double>::pi / designFactor);
+
+    auto delay = peak * (double)numStages / (double)designFactor;
+
+    auto length = juce::nextPowerOfTwo(juce::roundToInt(delay * ringFactor) + ringPadding);
+
+    return juce::jlimit(1 << minImpulseOrder, 1 << maxImpulseOrder, length);
+}
+
+void ExtendedDispersion::renderImpulse(const AllpassCoefficients& coefs, int numStages, int designFactor, juce::AudioBuffer<float>& impulse)
+{
+    auto length = impulse.getNumSamples();
+
+    //Twice the kept length. getStagesThatFit keeps the delayed energy inside the kept part, so
+    //what's left past the end to wrap round is far below the floor and the fade covers the rest.
+    auto order = juce::roundToInt(std::log2((double)length)) + 1;
+    auto fftSize = 1 << order;
+
+    juce::dsp::FFT fft(order);
+    std::vector<float> spectrum((size_t)fftSize * 2, 0.f);
+
+    auto b0 = coefs.b0;
+    auto b1 = coefs.b1;
+
+    for (int k = 0; k <= fftSize / 2; ++k)
+    {
+        auto omega = juce::MathConstants<double>::twoPi * (double)k / (double)fftSize / (double)designFactor;
+
+        //Same phase as AllpassResponse: -2w - 2 arg(A) per stage
+        auto aRe = 1.0 + b1 * std::cos(omega) + b0 * std::cos(2.0 * omega);
+        auto aIm = -(b1 * std::sin(omega) + b0 * std::sin(2.0 * omega));
+        auto phase = std::remainder((double)numStages * (-2.0 * omega - 2.0 * std::atan2(aIm, aRe)), juce::MathConstants<double>::twoPi);
+
+        spectrum[(size_t)k * 2] = (float)std::cos(phase);
+        spectrum[(size_t)k * 2 + 1] = (k == 0 || k == fftSize / 2) ? 0.f : (float)std::sin(phase);
+    }
+
+    fft.performRealOnlyInverseTransform(spectrum.data());
+
+    auto* data = impulse.getWritePointer(0);
+    std::copy(spectrum.begin(), spectrum.begin() + length, data);
+
+    //The last of the ringing fades out over the last eighth instead of being cut
+    auto fadeLength = length / 8;
+    auto fadeStart = length - fadeLength;
+
+    for (int i = 0; i < fadeLength; ++i)
+        data[fadeStart + i] *= .5f * (1.f + std::cos(juce::MathConstants<float>::pi * (float)i / (float)fadeLength));
+}
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    ExtendedDispersion.h
+    Created: 17 Oct 2026 7:12:44pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "AllpassCascade.h"
+
+//The "many stages" engine. Every stage of the cascade shares one design, so N stages
+//are just one allpass response raised to the N-th power. That's rendered straight into
+//an impulse response in the frequency domain, H^N = e^(j N phase(H)), and run through
+//juce::dsp::Convolution, which is uniformly partitioned and crossfades to each new
+//response on its own. The cost per sample depends on the response length, not on N.
+//
+//Rendering happens on one worker thread shared by every instance in the process. The
+//audio thread only posts the wanted settings, the worker picks them up, renders, and
+//hands the result to the convolution engines.
+//
+//Nothing is built until the engine is switched to Extended: the convolution engines,
+//the shared worker and its loading queue only exist while some instance is active.
+//
+//Responses are capped at 2^maxImpulseOrder samples. Low cutoffs with high stage counts
+//would delay their energy past that, where it would be cut or wrap round to the start
+//of the render, so those run as many stages as fit instead of the ones asked for.
+
+//The render worker and the queue that loads responses into the engines, one of each per process
+struct ImpulseThread : juce::TimeSliceThread
+{
+    ImpulseThread();
+    ~ImpulseThread() override;
+
+    juce::dsp::ConvolutionMessageQueue convolutionQueue;
+};
+
+struct ExtendedDispersion : juce::TimeSliceClient
+{
+    enum
+    {
+        maxStages = 2048,
+        minImpulseOrder = 12,
+        maxImpulseOrder = 18
+    };
+
+    ExtendedDispersion();
+    ~ExtendedDispersion() override;
+
+    //Message thread. prepare only remembers the layout unless the engine is active, then it
+    //rebuilds for it. setActive builds or releases the engines and the worker registration.
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+    void setActive(bool shouldBeActive);
+    bool isActive() const { return active; }
+
+    //Audio thread
+    void reset();
+
+    //Audio thread, wait-free. designFactor evaluates the design at that multiple of the
+    //sample rate, which takes the same warping out of the top octave as oversampling does.
+    void setParameters(float cutoff, float q, int numStages, int designFactor);
+    //Leaves the audio alone while the engines are missing or being swapped
+    void process(float* const* channels, int numChannels, int numSamples);
+
+    //Longest response handed to the engines since prepare, in samples. Once the input
+    //has been silent for this long the engines only have zeros left to add up.
+    int getTailSamples() const { return tailSamples; }
+
+    int useTimeSlice() override;
+
+    //numStages, or fewer if that many wouldn't fit in the longest response
+    static int getStagesThatFit(const AllpassCoefficients& coefs, int numStages, int designFactor);
+    //Long enough to hold the bulk of the delayed energy, as a power of two
+    static int getImpulseLength(const AllpassCoefficients& coefs, int numStages, int designFactor);
+    static void renderImpulse(const AllpassCoefficients& coefs, int numStages, int designFactor, juce::AudioBuffer<float>& impulse);
+
+private:
+    struct Settings
+    {
+        float cutoff = -1.f, q = -1.f;
+        int numStages = -1, designFactor = -1;
+
+        bool operator== (const Settings& other) const
+        {
+            return cutoff == other.cutoff && q == other.q && numStages == other.numStages && designFactor == other.designFactor;
+        }
+    };
+
+    using Engines = std::vector<std::unique_ptr<juce::dsp::Convolution>>;
+    Engines makeEngines() const;
+    void swapEngines(Engines& newEngines);
+
+    double sampleRate{ 0.0 };
+    int maxBlockSize{ 0 }, preparedChannels{ 0 };
+
+    std::atomic<float> wantedCutoff{ 200.f }, wantedQ{ .71f };
+    std::atomic<int> wantedStages{ 0 }, wantedFactor{ 1 };
+    std::atomic<int> tailSamples{ 0 };
+    std::atomic<bool> active{ false };
+
+    //Render thread only
+    Settings rendered;
+
+    //Held only while one of these exists, so the thread starts with the first active instance
+    //and stops with the last one
+    std::unique_ptr<juce::SharedResourcePointer<ImpulseThread>> impulseThread;
+
+    //Convolution only handles mono or stereo, so wider layouts get one engine per pair.
+    //The message thread swaps the set under the lock and the audio thread only tries it. The
+    //worker skips the lock, it's taken off the thread before any swap.
+    Engines convolutions;
+    juce::SpinLock engineLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ExtendedDispersion)
+};
@@ -0,0 +1,314 @@
+/*
+  ==============================================================================
+
+    HalfbandOversampler.cpp
+    Created: 17 Oct 2026 5:41:09pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "HalfbandOversampler.h"
+
+namespace
+{
+    //Elliptic half-band design, as in Laurent de Soras' HIIR. The coefficients come out
+    //sorted, even ones go in the first branch and odd ones in the second.
+    double sumNumerator(double q, int order, int c)
+    {
+        double acc = 0.0, term = 0.0;
+        double sign = 1.0;
+        int i = 0;
+
+        do
+        {
+            term = std::pow(q, (double)(i * (i + 1))) * std::sin((double)((i * 2 + 1) * c) * juce::MathConstants<double>::pi / (double)order) * sign;
+            acc += term;
+            sign = -sign;
+            ++i;
+        } while (std::abs(term) > 1e-100);
+
+        return acc;
+    }
+
+    double sumDenominator(double q, int order, int c)
+    {
+        double acc = 0.0, term = 0.0;
+        double sign = -1.0;
+        int i = 1;
+
+        do
+        {
+            term = std::pow(q, (double)(i * i)) * std::cos((double)(i * 2 * c) * juce::MathConstants<double>::pi / (double)order) * sign;
+            acc += term;
+            sign = -sign;
+            ++i;
+        } while (std::abs(term) > 1e-100);
+
+        return acc;
+    }
+}
+
+//=======================================HalfbandStage============================
+
+template <typename SampleType>
+void HalfbandStage<SampleType>::design(int numCoefs, double transition)
+{
+    numCoefficients = juce::jlimit(1, (int)maxCoefficients, numCoefs);
+
+    auto k = std::tan((1.0 - transition * 2.0) * juce::MathConstants<double>::pi / 4.0);
+    k *= k;
+
+    auto kkSqrt = std::pow(1.0 - k * k, .25);
+    auto e = .5 * (1.0 - kkSqrt) / (1.0 + kkSqrt);
+    auto e4 = e * e * e * e;
+    auto q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+    auto order = numCoefficients * 2 + 1;
+
+    for (int i = 0; i < numCoefficients; ++i)
+    {
+        auto c = i + 1;
+        auto ww = sumNumerator(q, order, c) * std::pow(q, .25) / (sumDenominator(q, order, c) + .5);
+        auto wwSquared = ww * ww;
+        auto x = std::sqrt((1.0 - wwSquared * k) * (1.0 - wwSquared / k)) / (1.0 + wwSquared);
+
+        coefficients[i] = (SampleType)((1.0 - x) / (1.0 + x));
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void HalfbandStage<SampleType>::prepare(int numChannels)
+{
+    state.resize((size_t)juce::jmax(1, numChannels));
+    reset();
+}
+
+template <typename SampleType>
+void HalfbandStage<SampleType>::reset()
+{
+    if (!state.empty())
+        juce::zeromem(state.data(), sizeof(ChannelState) * state.size());
+}
+
+template <typename SampleType>
+void HalfbandStage<SampleType>::upsample(const SampleType* const* input, SampleType* const* output, int numChannels, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* x = state[(size_t)ch].upX;
+            auto* y = state[(size_t)ch].upY;
+            auto even = input[ch][i];
+            auto odd = even;
+
+            int c = 0;
+
+            for (; c + 1 < numCoefficients; c += 2)
+            {
+                auto nextEven = (even - y[c]) * coefficients[c] + x[c];
+                auto nextOdd = (odd - y[c + 1]) * coefficients[c + 1] + x[c + 1];
+
+                x[c] = even;
+                x[c + 1] = odd;
+                y[c] = nextEven;
+                y[c + 1] = nextOdd;
+
+                even = nextEven;
+                odd = nextOdd;
+            }
+
+            if (c < numCoefficients)
+            {
+                auto nextEven = (even - y[c]) * coefficients[c] + x[c];
+                x[c] = even;
+                y[c] = nextEven;
+                even = nextEven;
+            }
+
+            output[ch][2 * i] = even;
+            output[ch][2 * i + 1] = odd;
+        }
+    }
+}
+
+template <typename SampleType>
+void HalfbandStage<SampleType>::downsample(const SampleType* const* input, SampleType* const* output, int numChannels, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* x = state[(size_t)ch].downX;
+            auto* y = state[(size_t)ch].downY;
+            auto even = input[ch][2 * i + 1];
+            auto odd = input[ch][2 * i];
+
+            int c = 0;
+
+            for (; c + 1 < numCoefficients; c += 2)
+            {
+                auto nextEven = (even - y[c]) * coefficients[c] + x[c];
+                auto nextOdd = (odd - y[c + 1]) * coefficients[c + 1] + x[c + 1];
+
+                x[c] = even;
+                x[c + 1] = odd;
+                y[c] = nextEven;
+                y[c + 1] = nextOdd;
+
+                even = nextEven;
+                odd = nextOdd;
+            }
+
+            if (c < numCoefficients)
+            {
+                auto nextEven = (even - y[c]) * coefficients[c] + x[c];
+                x[c] = even;
+                y[c] = nextEven;
+                even = nextEven;
+            }
+
+            output[ch][i] = SampleType(.5) * (even + odd);
+        }
+    }
+}
+
+template <typename SampleType>
+double HalfbandStage<SampleType>::getLatency() const
+{
+    //A first order allpass (a + z^-1) / (1 + a z^-1) is (1 - a) / (1 + a) samples late at DC,
+    //and each branch runs at half the high rate
+    double even = 0.0, odd = 0.0;
+
+    for (int c = 0; c < numCoefficients; ++c)
+    {
+        auto a = (double)coefficients[c];
+        auto delay = 2.0 * (1.0 - a) / (1.0 + a);
+
+        if (c % 2 == 0)
+            even += delay;
+        else
+            odd += delay;
+    }
+
+    //Upsampling averages the branches with the odd one a high rate sample later, downsampling
+    //feeds the odd branch a sample earlier, so the half samples cancel over the round trip
+    return even + odd;
+}
+
+template <typename SampleType>
+bool HalfbandStage<SampleType>::isSilent(SampleType threshold) const
+{
+    for (auto& channel : state)
+    {
+        for (int c = 0; c < numCoefficients; ++c)
+        {
+            if (std::abs(channel.upX[c]) > threshold || std::abs(channel.upY[c]) > threshold
+                || std::abs(channel.downX[c]) > threshold || std::abs(channel.downY[c]) > threshold)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//=======================================HalfbandOversampler======================
+
+template <typename SampleType>
+HalfbandOversampler<SampleType>::HalfbandOversampler()
+{
+    //At 44.1k the 2x step keeps 20k in the passband with over 110 dB of image rejection.
+    //Above that step the audio only fills the bottom quarter of the band, so 4x needs far fewer coefficients.
+    stages[0].design(10, .0313);
+    stages[1].design(6, .13);
+}
+
+template <typename SampleType>
+void HalfbandOversampler<SampleType>::prepare(int numChannels, int maximumBlockSize)
+{
+    numChannels = juce::jmax(1, numChannels);
+    auto size = juce::jmax(1, maximumBlockSize);
+
+    for (auto& stage : stages)
+        stage.prepare(numChannels);
+
+    for (int n = 1; n <= maxStages; ++n)
+    {
+        upBuffers[(size_t)n].setSize(numChannels, size << n);
+        upBuffers[(size_t)n].clear();
+        upPointers[(size_t)n].assign(upBuffers[(size_t)n].getArrayOfWritePointers(), upBuffers[(size_t)n].getArrayOfWritePointers() + numChannels);
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void HalfbandOversampler<SampleType>::reset()
+{
+    for (auto& stage : stages)
+        stage.reset();
+}
+
+template <typename SampleType>
+void HalfbandOversampler<SampleType>::setNumStages(int newNumStages)
+{
+    newNumStages = juce::jlimit(0, (int)maxStages, newNumStages);
+
+    if (newNumStages != numStages)
+    {
+        numStages = newNumStages;
+        reset();
+    }
+}
+
+template <typename SampleType>
+int HalfbandOversampler<SampleType>::getLatencySamples() const
+{
+    double latency = 0.0;
+
+    for (int n = 0; n < numStages; ++n)
+        latency += stages[(size_t)n].getLatency() / (double)(2 << n);
+
+    return juce::roundToInt(latency);
+}
+
+template <typename SampleType>
+bool HalfbandOversampler<SampleType>::isSilent(SampleType threshold) const
+{
+    for (int n = 0; n < numStages; ++n)
+        if (!stages[(size_t)n].isSilent(threshold))
+            return false;
+
+    return true;
+}
+
+template <typename SampleType>
+int HalfbandOversampler<SampleType>::processUp(const SampleType* const* channels, int numChannels, int numSamples)
+{
+    for (int n = 0; n < numStages; ++n)
+    {
+        auto* output = upPointers[(size_t)n + 1].data();
+        stages[(size_t)n].upsample(channels, output, numChannels, numSamples << n);
+        channels = output;
+    }
+
+    return numSamples << numStages;
+}
+
+template <typename SampleType>
+void HalfbandOversampler<SampleType>::processDown(SampleType* const* channels, int numChannels, int numSamples)
+{
+    for (int n = numStages - 1; n >= 0; --n)
+    {
+        auto* output = n == 0 ? channels : upPointers[(size_t)n].data();
+        stages[(size_t)n].downsample(upPointers[(size_t)n + 1].data(), output, numChannels, numSamples << n);
+    }
+}
+
+template struct HalfbandStage<float>;
+template struct HalfbandStage<double>;
+template struct HalfbandOversampler<float>;
+template struct HalfbandOversampler<double>;
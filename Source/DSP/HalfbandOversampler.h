@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    HalfbandOversampler.h
+    Created: 17 Oct 2026 5:41:09pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+
+//One 2x step of a polyphase IIR half-band oversampler. The half-band filter is
+//split into two branches of first order allpasses running at the lower rate,
+//so going up or down costs one multiply per coefficient and output sample at the
+//low rate, and there's no FIR history to convolve. Channels run side by side
+//inside the sample loop so their branch recursions can overlap in the pipeline.
+//
+//The filter isn't linear phase. getLatency() is the group delay at DC, which is
+//what the host compensates, the top octave lands slightly later than that.
+template <typename SampleType>
+struct HalfbandStage
+{
+    enum
+    {
+        maxCoefficients = 12
+    };
+
+    //transition is the gap between the passband edge and a quarter of the high
+    //rate, as a fraction of the high rate
+    void design(int numCoefficients, double transition);
+    void prepare(int numChannels);
+    void reset();
+
+    void upsample(const SampleType* const* input, SampleType* const* output, int numChannels, int numSamples);
+    void downsample(const SampleType* const* input, SampleType* const* output, int numChannels, int numSamples);
+
+    //Up plus down, in samples at the high rate
+    double getLatency() const;
+
+    bool isSilent(SampleType threshold) const;
+
+private:
+    SampleType coefficients[maxCoefficients] = {};
+    int numCoefficients{ 0 };
+
+    struct ChannelState
+    {
+        SampleType upX[maxCoefficients], upY[maxCoefficients];
+        SampleType downX[maxCoefficients], downY[maxCoefficients];
+    };
+
+    std::vector<ChannelState> state;
+};
+
+//Runs the dispersion at 1x, 2x or 4x. Only whatever sits between processUp and
+//processDown runs at the higher rate, and each stage halves the gap to the next,
+//so the cost grows with the factor and not faster.
+template <typename SampleType>
+struct HalfbandOversampler
+{
+    enum
+    {
+        maxStages = 2, //4x
+        maxFactor = 1 << maxStages
+    };
+
+    HalfbandOversampler();
+
+    void prepare(int numChannels, int maximumBlockSize);
+    void reset();
+
+    //0 is off, 1 is 2x, 2 is 4x. Clears the filter state, so only call it between blocks.
+    void setNumStages(int numStages);
+    int getNumStages() const { return numStages; }
+    int getFactor() const { return 1 << numStages; }
+
+    //Host latency for the current factor, in samples at the base rate
+    int getLatencySamples() const;
+
+    //True when none of the active stages holds more than threshold
+    bool isSilent(SampleType threshold) const;
+
+    //numChannels and numSamples must be within what was prepared. Returns the number of samples
+    //at the high rate, which are in getUpChannels() until processDown writes them back.
+    int processUp(const SampleType* const* channels, int numChannels, int numSamples);
+    void processDown(SampleType* const* channels, int numChannels, int numSamples);
+
+    SampleType* const* getUpChannels() { return upPointers[(size_t)numStages].data(); }
+
+private:
+    std::array<HalfbandStage<SampleType>, maxStages> stages;
+    int numStages{ 0 };
+
+    //Index n holds the signal at 2^n times the base rate, index 0 is never used
+    std::array<juce::AudioBuffer<SampleType>, maxStages + 1> upBuffers;
+    std::array<std::vector<SampleType*>, maxStages + 1> upPointers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HalfbandOversampler)
+};
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    dspLoadComp.cpp
+    Created: 17 Oct 2026 10:21:37pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "dspLoadComp.h"
+
+DspLoadComp::DspLoadComp(DspLoadMeter& m)
+    : meter(m)
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+DspLoadComp::~DspLoadComp()
+{
+}
+
+void DspLoadComp::update()
+{
+    auto now = juce::Time::getMillisecondCounter();
+
+    if (now - lastUpdate < updateIntervalMs)
+        return;
+
+    lastUpdate = now;
+
+    auto newStats = meter.getStats();
+
+    if (newStats.mean == stats.mean && newStats.p99 == stats.p99 && newStats.max == stats.max)
+        return;
+
+    stats = newStats;
+    repaint();
+}
+
+void DspLoadComp::paint(juce::Graphics& g)
+{
+    if (stats.numBlocks == 0)
+        return;
+
+    auto percent = [](float load) { return juce::String(load * 100.f, 1) + "%"; };
+
+    g.setColour(stats.max >= 1.f ? juce::Colours::red : juce::Colours::whitesmoke);
+    g.setFont(12);
+    g.drawText("DSP " + percent(stats.mean) + "  p99 " + percent(stats.p99) + "  max " + percent(stats.max),
+        getLocalBounds().reduced(4, 0), juce::Justification::topLeft, false);
+}
@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    dspLoadComp.h
+    Created: 17 Oct 2026 10:21:37pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../Utility/DspLoadMeter.h"
+
+//Mean, p99 and peak DSP load over the meter's window, as a line of text over the analyzer.
+//Red once the peak passes the buffer period.
+struct DspLoadComp : juce::Component
+{
+    DspLoadComp(DspLoadMeter& meter);
+    ~DspLoadComp();
+
+    void paint(juce::Graphics& g) override;
+
+    //Call from the message thread as often as you like, it reads the meter a few times a second
+    void update();
+
+private:
+    DspLoadMeter& meter;
+    DspLoadMeter::Stats stats;
+    juce::uint32 lastUpdate{ 0 };
+
+    static constexpr juce::uint32 updateIntervalMs = 250;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DspLoadComp)
+};
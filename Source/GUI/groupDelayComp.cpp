@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    groupDelayComp.cpp
+    Created: 17 Oct 2026 4:02:18pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "groupDelayComp.h"
+
+GroupDelayComp::GroupDelayComp(DisburserAudioProcessor& p)
+    : audioProcessor(p)
+{
+    scatter = p.apvts.getRawParameterValue("scatter");
+    cutoff = p.apvts.getRawParameterValue("cutoff");
+    smash = p.apvts.getRawParameterValue("smash");
+    oversampling = p.apvts.getRawParameterValue("oversampling");
+    engine = p.apvts.getRawParameterValue("engine");
+    extendedScatter = p.apvts.getRawParameterValue("extendedScatter");
+
+    setInterceptsMouseClicks(false, false);
+}
+
+GroupDelayComp::~GroupDelayComp()
+{
+}
+
+void GroupDelayComp::update()
+{
+    //The cascade is designed at the oversampled rate, which is what moves the top of the curve
+    auto sampleRate = audioProcessor.getSampleRate() * (double)(1 << juce::roundToInt(oversampling->load()));
+
+    if (sampleRate <= 0.0)
+        return;
+
+    //Either engine is the same response to a different power
+    auto scatterValue = engine->load() > .5f ? extendedScatter->load() : scatter->load();
+    auto cutoffValue = cutoff->load();
+    auto smashValue = smash->load();
+
+    auto rateChanged = sampleRate != response.getSampleRate();
+
+    if (!rateChanged && scatterValue == lastScatter && cutoffValue == lastCutoff && smashValue == lastSmash)
+        return;
+
+    if (rateChanged)
+        response.prepare(sampleRate, 256, 20.f, 20000.f);
+
+    lastScatter = scatterValue;
+    lastCutoff = cutoffValue;
+    lastSmash = smashValue;
+
+    auto design = AllpassCoefficients::make(sampleRate, cutoffValue, smashValue);
+    auto numStages = (int)scatterValue / 2;
+
+    //The extended engine leaves off stages that wouldn't fit its longest response
+    if (engine->load() > .5f)
+        numStages = ExtendedDispersion::getStagesThatFit(design, numStages, 1 << juce::roundToInt(oversampling->load()));
+
+    response.compute(design, numStages);
+    rebuildPaths();
+    repaint();
+}
+
+void GroupDelayComp::resized()
+{
+    rebuildPaths();
+}
+
+void GroupDelayComp::rebuildPaths()
+{
+    delayPath.clear();
+    phasePath.clear();
+
+    auto numPoints = response.getNumPoints();
+
+    if (numPoints == 0 || lastScatter < 2.f)
+        return;
+
+    float width = getWidth();
+    float height = getHeight();
+
+    auto& delay = response.groupDelayMs;
+    auto& phase = response.phase;
+
+    maxDelayMs = juce::FloatVectorOperations::findMaximum(delay.data(), numPoints);
+    auto phaseRange = juce::FloatVectorOperations::findMinAndMax(phase.data(), numPoints);
+
+    if (maxDelayMs <= 0.f)
+        return;
+
+    auto phaseSpan = juce::jmax(1.0e-6f, phaseRange.getLength());
+
+    for (int i = 0; i < numPoints; i++)
+    {
+        auto x = juce::mapFromLog10(response.frequencies[(size_t)i], 20.f, 20000.f) * width;
+        auto delayY = height - delay[(size_t)i] / maxDelayMs * height * .9f;
+        auto phaseY = height - (phase[(size_t)i] - phaseRange.getStart()) / phaseSpan * height * .9f;
+
+        if (i == 0)
+        {
+            delayPath.startNewSubPath(x, delayY);
+            phasePath.startNewSubPath(x, phaseY);
+        }
+        else
+        {
+            delayPath.lineTo(x, delayY);
+            phasePath.lineTo(x, phaseY);
+        }
+    }
+}
+
+void GroupDelayComp::paint(juce::Graphics& g)
+{
+    if (delayPath.isEmpty())
+        return;
+
+    g.setColour(juce::Colours::whitesmoke.withAlpha(.3f));
+    g.strokePath(phasePath, juce::PathStrokeType(1));
+
+    g.setColour(juce::Colours::whitesmoke);
+    g.strokePath(delayPath, juce::PathStrokeType(1.5f));
+
+    g.setFont(12);
+    g.drawText(juce::String(maxDelayMs, 1) + " ms", getLocalBounds().removeFromTop(14).reduced(4, 0), juce::Justification::topRight, false);
+}
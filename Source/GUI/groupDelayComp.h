@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    groupDelayComp.h
+    Created: 17 Oct 2026 4:02:18pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../PluginProcessor.h"
+#include "../DSP/AllpassResponse.h"
+
+//Group delay and phase of the current cascade, drawn over the analyzer.
+//The curves are only recomputed when scatter, cutoff, smash or the sample rate
+//move, paint just strokes the cached paths.
+struct GroupDelayComp : juce::Component
+{
+    GroupDelayComp(DisburserAudioProcessor& p);
+    ~GroupDelayComp();
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    //Call from the message thread whenever, it returns straight away if nothing changed
+    void update();
+
+private:
+    void rebuildPaths();
+
+    DisburserAudioProcessor& audioProcessor;
+    std::atomic<float>* scatter{ nullptr };
+    std::atomic<float>* cutoff{ nullptr };
+    std::atomic<float>* smash{ nullptr };
+    std::atomic<float>* oversampling{ nullptr };
+    std::atomic<float>* engine{ nullptr };
+    std::atomic<float>* extendedScatter{ nullptr };
+
+    float lastScatter{ -1.f }, lastCutoff{ -1.f }, lastSmash{ -1.f };
+
+    AllpassResponse response;
+    float maxDelayMs{ 0.f };
+
+    juce::Path delayPath, phasePath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GroupDelayComp)
+};
@@ -18,27 +18,17 @@ void Laf::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int heigh
     auto fill = Colour(64u, 194u, 230u);
 
     auto bounds = Rectangle<int>(x, y, width, height).toFloat();
+    auto& geometry = getRotaryGeometry(bounds, rotaryStartAngle, rotaryEndAngle);
 
-    auto radius = jmin(bounds.getWidth(), bounds.getHeight()) / 2.0f;
+    auto radius = geometry.radius;
+    auto arcRadius = geometry.arcRadius;
+    auto lineW = geometry.lineW;
     auto toAngle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
-    auto lineW = jmin(8.f, radius * 0.5f);
-    auto arcRadius = radius - lineW * .25;
-
 
     auto rootTwo = MathConstants<float>::sqrt2;
 
-    Path backgroundArc;
-    backgroundArc.addCentredArc(bounds.getCentreX(),
-        bounds.getCentreY(),
-        arcRadius,
-        arcRadius,
-        0.0f,
-        rotaryStartAngle,
-        rotaryEndAngle,
-        true);
-
     g.setColour(unfill);
-    g.strokePath(backgroundArc, PathStrokeType(lineW/2, PathStrokeType::curved, PathStrokeType::rounded));
+    g.fillPath(geometry.backgroundArc);
 
     if (slider.isEnabled())
     {
@@ -58,11 +48,11 @@ void Laf::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int heigh
 
     //Set Circle color
     g.setColour(Colours::black);
-    g.fillRoundedRectangle(bounds.getCentreX() - (radius * rootTwo / 2), bounds.getCentreY() - (radius * rootTwo / 2), radius * rootTwo, radius * rootTwo, radius * .7);
+    g.fillPath(geometry.dialFace);
 
     //add circle around dial
     g.setColour(Colour(186u, 34u, 34u));
-    g.drawRoundedRectangle(bounds.getCentreX() - (radius * rootTwo / 2), bounds.getCentreY() - (radius * rootTwo / 2), radius * rootTwo, radius * rootTwo, radius * .7, 1.5f);
+    g.fillPath(geometry.dialRing);
 
     //make dial line
     g.setColour(Colours::whitesmoke);
@@ -76,6 +66,54 @@ void Laf::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int heigh
 
 }
 
+const Laf::RotaryGeometry& Laf::getRotaryGeometry(juce::Rectangle<float> bounds, float startAngle, float endAngle)
+{
+    using namespace juce;
+
+    for (auto& entry : rotaryCache)
+        if (entry.bounds == bounds && entry.startAngle == startAngle && entry.endAngle == endAngle)
+            return entry;
+
+    //Only a handful of sizes are ever live at once, anything older is from before a resize
+    if (rotaryCache.size() >= 8)
+        rotaryCache.clear();
+
+    RotaryGeometry geometry;
+    geometry.bounds = bounds;
+    geometry.startAngle = startAngle;
+    geometry.endAngle = endAngle;
+
+    geometry.radius = jmin(bounds.getWidth(), bounds.getHeight()) / 2.0f;
+    geometry.lineW = jmin(8.f, geometry.radius * 0.5f);
+    geometry.arcRadius = geometry.radius - geometry.lineW * .25f;
+
+    auto radius = geometry.radius;
+    auto rootTwo = MathConstants<float>::sqrt2;
+
+    //Stroked up front at a finer tolerance so the cached outlines still look smooth on hi-dpi screens
+    constexpr float extraAccuracy = 4.f;
+
+    Path backgroundArc;
+    backgroundArc.addCentredArc(bounds.getCentreX(),
+        bounds.getCentreY(),
+        geometry.arcRadius,
+        geometry.arcRadius,
+        0.0f,
+        startAngle,
+        endAngle,
+        true);
+
+    PathStrokeType(geometry.lineW / 2, PathStrokeType::curved, PathStrokeType::rounded)
+        .createStrokedPath(geometry.backgroundArc, backgroundArc, {}, extraAccuracy);
+
+    geometry.dialFace.addRoundedRectangle(bounds.getCentreX() - (radius * rootTwo / 2), bounds.getCentreY() - (radius * rootTwo / 2), radius * rootTwo, radius * rootTwo, radius * .7f);
+
+    PathStrokeType(1.5f).createStrokedPath(geometry.dialRing, geometry.dialFace, {}, extraAccuracy);
+
+    rotaryCache.push_back(std::move(geometry));
+    return rotaryCache.back();
+}
+
 void Laf::drawToggleButton(juce::Graphics& g, juce::ToggleButton& button,
     bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDown)
 {
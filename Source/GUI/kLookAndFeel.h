@@ -33,5 +33,19 @@ struct Laf : juce::LookAndFeel_V4 {
         const juce::Slider::SliderStyle, juce::Slider& slider) override;
 
 private:
+    //Everything about a knob that only depends on its size and angles, so a drag only rebuilds the value arc
+    struct RotaryGeometry
+    {
+        juce::Rectangle<float> bounds;
+        float startAngle = 0.f, endAngle = 0.f;
+        float radius = 0.f, lineW = 0.f, arcRadius = 0.f;
+        juce::Path backgroundArc, dialFace, dialRing;
+    };
+
+    const RotaryGeometry& getRotaryGeometry(juce::Rectangle<float> bounds, float startAngle, float endAngle);
+
+    //One entry per knob size in use, shared by every slider drawn with this Laf
+    std::vector<RotaryGeometry> rotaryCache;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Laf)
 };
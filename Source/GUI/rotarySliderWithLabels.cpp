@@ -32,24 +32,51 @@ void RotarySliderWithLabels::paint(juce::Graphics& g) {
         endAng,
         *this);
 
+    g.setColour(Colours::white);
+
+    updateLabelLayout(sliderBounds);
+
+    for (auto& layout : labelLayout)
+    {
+        g.setFont(layout.font);
+        g.drawFittedText(layout.source.label, layout.area, juce::Justification::centred, 2, 1);
+    }
+}
+
+void RotarySliderWithLabels::updateLabelLayout(const juce::Rectangle<int>& sliderBounds)
+{
+    using namespace juce;
+
+    if (sliderBounds != layoutBounds)
+    {
+        labelLayout.clearQuick();
+        layoutBounds = sliderBounds;
+    }
+
+    labelLayout.resize(labels.size());
+
     auto center = sliderBounds.toFloat().getCentre();
     auto radius = sliderBounds.getHeight() * .5f;
 
-    g.setColour(Colours::white);
+    for (int i = 0; i < labels.size(); ++i)
+    {
+        auto& source = labels.getReference(i);
+        auto& layout = labelLayout.getReference(i);
 
-    auto numChoices = labels.size();
+        if (!layout.area.isEmpty() && layout.source.pos == source.pos && layout.source.fontSize == source.fontSize && layout.source.label == source.label)
+            continue;
+
+        layout.source = source;
 
-    for(int i = 0; i < numChoices; ++i)
-    {
         Rectangle<float> r;
         Point<float> c;
 
-        auto pos = labels[i].pos;
-        auto str = labels[i].label;
-        auto textHeight = labels[i].fontSize;
-        g.setFont(textHeight);
-        auto strWidth = g.getCurrentFont().getStringWidth(str);
-        
+        auto pos = source.pos;
+        auto& str = source.label;
+        auto textHeight = source.fontSize;
+        layout.font = Font().withHeight((float)textHeight);
+        auto strWidth = layout.font.getStringWidth(str);
+
         r.setSize(strWidth, textHeight); //draww text on edge of slider bounds, or create a slightly bigger bounds and draw them on that
 
         if (pos == 1) //Will need to do something based on ratios. Normal sliders this does not work for 2 & 4
@@ -74,7 +101,7 @@ void RotarySliderWithLabels::paint(juce::Graphics& g) {
             r.setCentre(c);
         }
 
-        g.drawFittedText(str, r.toNearestInt(), juce::Justification::centred, 2, 1);
+        layout.area = r.toNearestInt();
     }
 }
 
@@ -96,7 +123,7 @@ void RotarySliderWithLabels::changeParam(juce::RangedAudioParameter* p)
     repaint();
 }
 
-juce::String getValString(const juce::RangedAudioParameter& param, bool isName, juce::String suffix, std::vector<juce::String> vector)
+juce::String getValString(const juce::RangedAudioParameter& param, bool isName, const juce::String& suffix, const std::vector<juce::String>& vector)
 {
     juce::String str;
 
@@ -39,6 +39,19 @@ protected:
     juce::RangedAudioParameter* param;
     juce::String suffix;
 
+    //Measured text and position for each label. An entry is only re-measured when its text,
+    //position or font size changes, and everything is dropped when the slider bounds change.
+    struct LabelLayout {
+        LabelPos source;
+        juce::Font font;
+        juce::Rectangle<int> area;
+    };
+
+    void updateLabelLayout(const juce::Rectangle<int>& sliderBounds);
+
+    juce::Array<LabelLayout> labelLayout;
+    juce::Rectangle<int> layoutBounds;
+
 };
 
 template <
@@ -69,17 +82,33 @@ juce::RangedAudioParameter& getParam(APVTS& apvts, const Name& name)
 }
 
 
-juce::String getValString(const juce::RangedAudioParameter& param, bool getLow, juce::String suffix, std::vector<juce::String>);
+juce::String getValString(const juce::RangedAudioParameter& param, bool getLow, const juce::String& suffix, const std::vector<juce::String>& = {});
 
 template <
     typename Labels,
     typename ParamType,
     typename SuffixType
 >
-void addLabelPairs(Labels& labels, const int posOne, const int posTwo, const ParamType& param, const SuffixType& suffix, const int fontSize = 14, std::vector<juce::String> array = std::vector<juce::String>())
+void addLabelPairs(Labels& labels, const int posOne, const int posTwo, const ParamType& param, const SuffixType& suffix, const int fontSize = 14, const std::vector<juce::String>& array = {})
 {
-    labels.clear();
-    labels.add({ posOne, getValString(param, true, suffix, array), fontSize });
-    labels.add({ posTwo, getValString(param, false, suffix, array), fontSize });
+    //This runs on every value change while dragging, so once the pair exists only changed text is written
+    if (labels.size() != 2 || labels[0].pos != posOne || labels[1].pos != posTwo)
+    {
+        labels.clear();
+        labels.add({ posOne, getValString(param, true, suffix, array), fontSize });
+        labels.add({ posTwo, getValString(param, false, suffix, array), fontSize });
+        return;
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        auto& label = labels.getReference(i);
+        auto str = getValString(param, i == 0, suffix, array);
+
+        if (label.label != str)
+            label.label = str;
+
+        label.fontSize = fontSize;
+    }
 }
 
@@ -9,36 +9,73 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+EditorResources::EditorResources()
+    : logo(juce::ImageCache::getFromMemory(BinaryData::KITIK_LOGO_NO_BKGD_png, BinaryData::KITIK_LOGO_NO_BKGD_pngSize)),
+    titleTypeface(juce::Typeface::createSystemTypefaceFor(BinaryData::offshore_ttf, BinaryData::offshore_ttfSize))
+{
+}
+
 //==============================================================================
 DisburserAudioProcessorEditor::DisburserAudioProcessorEditor (DisburserAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p), fftComp(p.fftData),
+    : AudioProcessorEditor (&p), audioProcessor (p), fftComp(p.fftData), groupDelay(p), dspLoad(p.loadMeter),
     cutoffAT(p.apvts, "cutoff", cutoff)
 {
     
     setLookAndFeel(&lnf);
+    setOpaque(true);
     updateRSWL();
+    setupChoices();
 
     cutoff.setSliderStyle(juce::Slider::SliderStyle::LinearBar);
 
     cutoff.setTextBoxStyle(juce::Slider::NoTextBox, false, 100, 20);
 
     addAndMakeVisible(fftComp);
+    addAndMakeVisible(groupDelay);
+    addChildComponent(dspLoad);
     addAndMakeVisible(*scatter);
     addAndMakeVisible(*smash);
     addAndMakeVisible(cutoff);
+    addAndMakeVisible(oversampling);
+    addAndMakeVisible(engine);
+    addAndMakeVisible(extendedScatter);
     addAndMakeVisible(gumroad);
+
+    //The cutoff bar covers the analyzer, so its right clicks open the editor's menu too
+    cutoff.addMouseListener(this, false);
     
     setSize (600, 150);
-    startTimerHz(24);
 }
 
 DisburserAudioProcessorEditor::~DisburserAudioProcessorEditor()
 {
+    cutoff.removeMouseListener(this);
     setLookAndFeel(nullptr);
 }
 
 //==============================================================================
 void DisburserAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    //The analyzer and group delay overlay aren't opaque, so this runs under every repaint they get:
+    //a vblank that finds a new analyzer frame, or a change in the cascade settings
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (chrome.isNull() || scale != chromeScale)
+    {
+        chromeScale = scale;
+        chrome = juce::Image(juce::Image::RGB, juce::jmax(1, juce::roundToInt(getWidth() * scale)),
+            juce::jmax(1, juce::roundToInt(getHeight() * scale)), false);
+
+        juce::Graphics chromeGraphics(chrome);
+        chromeGraphics.addTransform(juce::AffineTransform::scale(scale));
+        drawChrome(chromeGraphics);
+    }
+
+    g.drawImage(chrome, getLocalBounds().toFloat());
+}
+
+void DisburserAudioProcessorEditor::drawChrome(juce::Graphics& g)
 {
     g.fillAll (juce::Colours::black);
 
@@ -50,11 +87,9 @@ void DisburserAudioProcessorEditor::paint (juce::Graphics& g)
     logoArea.removeFromRight(logoArea.getWidth() * .9);
     logoArea.expand(logoArea.getWidth() * .2, logoArea.getHeight() * .2);
 
-    auto logo = juce::ImageCache::getFromMemory(BinaryData::KITIK_LOGO_NO_BKGD_png, BinaryData::KITIK_LOGO_NO_BKGD_pngSize);
-    g.drawImage(logo, logoArea.toFloat(), juce::RectanglePlacement::centred);
+    g.drawImage(resources->logo, logoArea.toFloat(), juce::RectanglePlacement::centred);
 
-    auto newFont = juce::Font(juce::Typeface::createSystemTypefaceFor(BinaryData::offshore_ttf, BinaryData::offshore_ttfSize));
-    g.setFont(newFont);
+    g.setFont(juce::Font(resources->titleTypeface));
     g.setFont (top.getHeight() * .95);
 
     g.drawFittedText("Disburser", top.toNearestInt(), juce::Justification::Justification::centred, 1);
@@ -63,6 +98,8 @@ void DisburserAudioProcessorEditor::paint (juce::Graphics& g)
 
 void DisburserAudioProcessorEditor::resized()
 {
+    chrome = {};
+
     auto bounds = getLocalBounds();
     auto top = bounds.removeFromTop(bounds.getHeight() * .25);
 
@@ -72,13 +109,20 @@ void DisburserAudioProcessorEditor::resized()
     auto rRightKnob = rightKnob.reduced(rightKnob.getWidth() * .05, 0);
     auto middle = bounds.reduced(bounds.getWidth() * .025, 0);
     middle.removeFromTop(middle.getHeight() * .25);
-    middle.removeFromBottom(middle.getHeight() * .33);
+    auto choices = middle.removeFromBottom(middle.getHeight() * .33).reduced(0, 5);
 
     fftComp.setBounds(middle);
+    groupDelay.setBounds(middle);
+    dspLoad.setBounds(middle.withHeight(14));
     scatter->setBounds(rLeftKnob);
     cutoff.setBounds(middle);
     smash->setBounds(rRightKnob);
 
+    auto choiceWidth = choices.getWidth() / 3;
+    oversampling.setBounds(choices.removeFromLeft(choiceWidth).reduced(2, 0));
+    engine.setBounds(choices.removeFromLeft(choiceWidth).reduced(2, 0));
+    extendedScatter.setBounds(choices.reduced(2, 0));
+
     auto linkSpace = top.removeFromRight(top.getWidth() * .15);
     auto font = juce::Font();
     gumroad.setFont(font, false, juce::Justification::centred);
@@ -86,9 +130,87 @@ void DisburserAudioProcessorEditor::resized()
     gumroad.setBounds(linkSpace);
 }
 
-void DisburserAudioProcessorEditor::timerCallback()
+void DisburserAudioProcessorEditor::onVBlank()
 {
-    fftComp.repaint();
+    //Nothing to do while minimised or hidden behind another tab of the host
+    if (!isShowing())
+        return;
+
+    if (auto* peer = getPeer(); peer != nullptr && peer->isMinimised())
+        return;
+
+    //The analyzer stops publishing once the input has gone silent, so idle sessions fall through here
+    if (audioProcessor.fftData.hasNewFrame())
+        fftComp.repaint();
+
+    groupDelay.update();
+
+    if (dspLoad.isVisible())
+        dspLoad.update();
+}
+
+void DisburserAudioProcessorEditor::mouseDown(const juce::MouseEvent& e)
+{
+    //The cutoff bar sits on top of the analyzer, so its display settings live on the editor's right click
+    if (!e.mods.isPopupMenu())
+        return;
+
+    auto menu = fftComp.getSettingsMenu();
+    menu.addSeparator();
+    menu.addItem("Group Delay", true, groupDelay.isVisible(), [this]() { groupDelay.setVisible(!groupDelay.isVisible()); });
+    menu.addItem("DSP Load", true, dspLoad.isVisible(), [this]() { dspLoad.setVisible(!dspLoad.isVisible()); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options());
+}
+
+void DisburserAudioProcessorEditor::setupChoices()
+{
+    auto& apvts = audioProcessor.apvts;
+
+    //The attachments pick items by index, so the lists have to be in place first
+    auto* oversamplingParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("oversampling"));
+    for (int i = 0; i < oversamplingParam->choices.size(); ++i)
+        oversampling.addItem(i == 0 ? "No Oversampling" : oversamplingParam->choices[i] + " Oversampling", i + 1);
+
+    auto* engineParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("engine"));
+    for (int i = 0; i < engineParam->choices.size(); ++i)
+        engine.addItem(engineParam->choices[i] + " Engine", i + 1);
+
+    oversamplingAT = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, "oversampling", oversampling);
+    engineAT = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, "engine", engine);
+
+    //The scatter knob keeps driving the cascade, the extended engine's depth is picked here
+    const int depths[] = { 128, 256, 512, 1024, 2048, 4096 };
+
+    for (auto depth : depths)
+        extendedScatter.addItem("Extended " + juce::String(depth), depth);
+
+    extendedScatterAT = std::make_unique<juce::ParameterAttachment>(getParam(apvts, "extendedScatter"),
+        [this](float value)
+        {
+            //Automation can land between the listed depths, that just shows as text
+            auto depth = juce::roundToInt(value);
+
+            if (extendedScatter.indexOfItemId(depth) >= 0)
+                extendedScatter.setSelectedId(depth, juce::dontSendNotification);
+            else
+                extendedScatter.setText("Extended " + juce::String(depth), juce::dontSendNotification);
+        });
+
+    extendedScatter.onChange = [this]()
+        {
+            if (auto depth = extendedScatter.getSelectedId(); depth != 0)
+                extendedScatterAT->setValueAsCompleteGesture((float)depth);
+        };
+
+    //Attachment updates arrive with a notification, so this follows the host as well
+    engine.onChange = [this]()
+        {
+            extendedScatter.setEnabled(engine.getSelectedItemIndex() == 1);
+        };
+
+    extendedScatterAT->sendInitialUpdate();
+    engine.onChange();
 }
 
 void DisburserAudioProcessorEditor::updateRSWL()
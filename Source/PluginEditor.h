@@ -14,11 +14,25 @@
 #include "GUI/kLookAndFeel.h"
 #include "Utility/KiTiK_utilityViz.h"
 #include "GUI/rotarySliderWithLabels.h"
+#include "GUI/groupDelayComp.h"
+#include "GUI/dspLoadComp.h"
 
 //==============================================================================
 /**
+    Decoded once per process and shared by every open editor
 */
-class DisburserAudioProcessorEditor : public juce::AudioProcessorEditor, public juce::Timer
+struct EditorResources
+{
+    EditorResources();
+
+    juce::Image logo;
+    juce::Typeface::Ptr titleTypeface;
+};
+
+//==============================================================================
+/**
+*/
+class DisburserAudioProcessorEditor : public juce::AudioProcessorEditor
 {
 public:
     DisburserAudioProcessorEditor (DisburserAudioProcessor&);
@@ -27,20 +41,31 @@ public:
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
-    void timerCallback() override;
+    void mouseDown(const juce::MouseEvent& e) override;
 
 private:
 
     void updateRSWL();
+    void setupChoices();
+    void onVBlank();
+    void drawChrome(juce::Graphics& g);
 
     DisburserAudioProcessor& audioProcessor;
 
+    juce::SharedResourcePointer<EditorResources> resources;
+
+    //Background, logo, title and divider rendered at device scale, rebuilt on resize or scale change
+    juce::Image chrome;
+    float chromeScale = 0.f;
+
     Laf lnf;
 
     juce::URL url{ "https://kwhaley5.gumroad.com/" };
     juce::HyperlinkButton gumroad{ "More Plugins", url };
 
     FFTComp fftComp;
+    GroupDelayComp groupDelay;
+    DspLoadComp dspLoad;
 
     juce::Slider cutoff;
     std::unique_ptr<RotarySliderWithLabels> scatter, smash;
@@ -48,5 +73,16 @@ private:
     juce::AudioProcessorValueTreeState::SliderAttachment cutoffAT;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> scatterAT, smashAT;
 
+    //Setup choices along the strip under the analyzer. Extended Scatter is a float parameter
+    //picked from a few useful depths, so it gets a plain ParameterAttachment rather than the
+    //index based ComboBoxAttachment.
+    juce::ComboBox oversampling, engine, extendedScatter;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingAT, engineAT;
+    std::unique_ptr<juce::ParameterAttachment> extendedScatterAT;
+
+    //Repaints are driven by the display refresh, but only go out when the analysis
+    //thread has published a frame since the last one. Declared last so it detaches first.
+    juce::VBlankAttachment vBlank{ this, [this]() { onVBlank(); } };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DisburserAudioProcessorEditor)
 };
@@ -8,6 +8,8 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "DSP/AllpassResponse.h"
+#include "Utility/RealtimeSanitizer.h"
 
 //==============================================================================
 DisburserAudioProcessor::DisburserAudioProcessor()
@@ -25,10 +27,17 @@ DisburserAudioProcessor::DisburserAudioProcessor()
     scatter = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("scatter"));
     cutoff = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("cutoff"));
     smash = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("smash"));
+    oversampling = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("oversampling"));
+    engine = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("engine"));
+    extendedScatter = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("extendedScatter"));
+
+    apvts.addParameterListener("engine", this);
 }
 
 DisburserAudioProcessor::~DisburserAudioProcessor()
 {
+    apvts.removeParameterListener("engine", this);
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -66,7 +75,34 @@ bool DisburserAudioProcessor::isMidiEffect() const
 
 double DisburserAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    auto sampleRate = getSampleRate();
+
+    if (sampleRate <= 0.0)
+        return 0.0;
+
+    //Both engines evaluate the design at the oversampled rate
+    auto factor = 1 << oversampling->getIndex();
+    auto design = AllpassCoefficients::make(sampleRate * factor, cutoff->get(), smash->get());
+
+    if (engine->getIndex() == 1)
+    {
+        auto numStages = ExtendedDispersion::getStagesThatFit(design, (int)extendedScatter->get() / 2, factor);
+        return ExtendedDispersion::getImpulseLength(design, numStages, factor) / sampleRate;
+    }
+
+    auto numStages = (int)scatter->get() / 2;
+    auto latency = factor > 1 ? (double)floatDispersion.oversampler.getLatencySamples() : 0.0;
+
+    if (numStages == 0)
+        return latency / sampleRate;
+
+    //The peak delay is where the bulk of the energy arrives, the slowest pole then rings down from there.
+    //Repeated poles ring a little longer than one does, measured impulses stay within a quarter more.
+    auto peak = AllpassResponse::getPeakStageGroupDelay(design, juce::MathConstants<double>::pi / factor);
+    auto decay = AllpassResponse::getDecaySamples(design, silenceThreshold);
+    auto tail = 1.25 * (peak * numStages + decay) / (sampleRate * factor) + latency / sampleRate;
+
+    return juce::jmin(tail, maxTailSeconds);
 }
 
 int DisburserAudioProcessor::getNumPrograms()
@@ -96,17 +132,57 @@ void DisburserAudioProcessor::changeProgramName (int index, const juce::String&
 //==============================================================================
 void DisburserAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.sampleRate = sampleRate;
-    spec.numChannels = getTotalNumInputChannels();
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    preparedChannels = juce::jmax(1, getTotalNumOutputChannels());
+    oversamplingStages = oversampling->getIndex();
 
-    for (auto& all : allpasses)
-    {
-        all.prepare(spec);
-    }
+    auto prepareDispersion = [&](auto& dispersion)
+        {
+            using Cascade = typename std::decay_t<decltype(dispersion.cascades)>::value_type::element_type;
+
+            dispersion.oversampler.prepare(preparedChannels, maxBlockSize);
+            dispersion.oversampler.setNumStages(oversamplingStages);
+
+            auto numGroups = (preparedChannels + Cascade::numLanes - 1) / Cascade::numLanes;
+            dispersion.cascades.resize((size_t)numGroups);
+
+            for (auto& cascade : dispersion.cascades)
+            {
+                if (cascade == nullptr)
+                    cascade = std::make_unique<Cascade>();
+
+                cascade->prepare(sampleRate * getOversamplingFactor(), maxBlockSize);
+                cascade->setNumStages((int)scatter->get() / 2);
+            }
+
+            dispersion.offsetChannels.assign((size_t)preparedChannels, nullptr);
+        };
+
+    prepareDispersion(floatDispersion);
+    prepareDispersion(doubleDispersion);
+
+    //Both precisions share one design, so either oversampler can answer
+    oversamplingLatency = floatDispersion.oversampler.getLatencySamples();
+
+    extended.prepare(sampleRate, maxBlockSize, preparedChannels);
+    extended.setActive(engine->getIndex() == 1);
+    extended.setParameters(cutoff->get(), smash->get(), (int)extendedScatter->get() / 2, getOversamplingFactor());
+    extendedScratch.setSize(preparedChannels, maxBlockSize);
+    usingExtended = extended.isActive();
+    silentSamples = 0;
+
+    updateLatency();
+
+    cutoffSmoothed.reset(sampleRate, .05);
+    smashSmoothed.reset(sampleRate, .05);
+    cutoffSmoothed.setCurrentAndTargetValue(cutoff->get());
+    smashSmoothed.setCurrentAndTargetValue(smash->get());
+
+    lastSampleRate = 0.0;
+    updateCoefficients(0);
 
     fftData.prepare(sampleRate);
+    loadMeter.prepare(sampleRate);
 }
 
 void DisburserAudioProcessor::releaseResources()
@@ -122,12 +198,9 @@ bool DisburserAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel gets the same dispersion, so any layout works as long as
+    // there's something on it: mono, stereo, surround, ambisonics.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -143,63 +216,285 @@ bool DisburserAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 
 void DisburserAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    processSamples(buffer);
+}
+
+void DisburserAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+bool DisburserAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    //Long high Q cascades at low cutoffs gather float round-off, a double host can skip the conversion
+    return true;
+}
+
+template <typename SampleType>
+void DisburserAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
+{
+    RealtimeSanitizer::Scope realtime;
+    DspLoadMeter::ScopedTimer loadTimer(loadMeter, buffer.getNumSamples());
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    auto dataLeft = buffer.getWritePointer(0);
-    auto dataRight = buffer.getWritePointer(1);
+    fftData.pushPreProcessing(buffer);
 
-    //To make AU val happy
-    if (totalNumInputChannels == 1)
-        dataRight = buffer.getWritePointer(0);
+    auto& dispersion = getDispersion<SampleType>();
+    auto numChannels = juce::jmin(buffer.getNumChannels(), preparedChannels);
+    auto numSamples = buffer.getNumSamples();
+    auto numStages = (int)scatter->get() / 2;
 
-    auto coef = juce::dsp::IIR::Coefficients<float>::makeAllPass(getSampleRate(), cutoff->get(), smash->get());
-    auto scatterValue = scatter->get();
+    cutoffSmoothed.setTargetValue(cutoff->get());
+    smashSmoothed.setTargetValue(smash->get());
 
-    //Prevent lots of popping when moving the amount button
-    scatterValues.push_back(scatterValue);
-    if (scatterValues.size() > 60)
-    {
-        scatterValues.erase(scatterValues.begin());
-    }
+    updateOversampling();
 
-    auto scatterSize = scatterValues.size();
-
-    for (int i = 0; i < scatterSize; i++)
+    //Switching engines is a setup choice like the oversampling factor, it doesn't fade.
+    //Extended takes over once the message thread has built its convolutions.
+    if (auto useExtended = engine->getIndex() == 1 && extended.isActive(); useExtended != usingExtended)
     {
-        avgValue += scatterValues[i];
+        usingExtended = useExtended;
+        silentSamples = 0;
+        extended.reset();
+
+        for (auto& cascade : dispersion.cascades)
+            cascade->reset();
     }
-    
-    if((avgValue / scatterSize) == scatterValue)
+
+    //Both engines are prepared for the host's block size, so anything bigger goes through in pieces
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
     {
-        for (int s = 0; s < buffer.getNumSamples(); s++)
+        auto num = juce::jmin(maxBlockSize, numSamples - offset);
+        auto inputSilent = true;
+
+        for (int ch = 0; ch < numChannels && inputSilent; ++ch)
+            inputSilent = buffer.getMagnitude(ch, offset, num) <= (SampleType)silenceThreshold;
+
+        auto previousSilence = silentSamples;
+        silentSamples = inputSilent ? juce::jmin(silentSamples + num, 1 << ExtendedDispersion::maxImpulseOrder) : 0;
+
+        if (usingExtended)
         {
-            auto left = dataLeft[s];
-            auto right = dataRight[s];
-            auto allpass = allpasses.data();
+            //The convolution fades between responses itself, so the cascade's smoothers just follow
+            //the knobs. Switching back then starts from where they are rather than a stale ramp.
+            cutoffSmoothed.setCurrentAndTargetValue(cutoff->get());
+            smashSmoothed.setCurrentAndTargetValue(smash->get());
 
-            for (int filter = 0; filter < scatterValue; filter += 2)
+            //Designed at the oversampled rate too, but the convolution itself runs at the host's
+            extended.setParameters(cutoff->get(), smash->get(), (int)extendedScatter->get() / 2, getOversamplingFactor());
+
+            //Everything before the silence has played through the longest response, so the output is zeros too
+            if (inputSilent && previousSilence >= extended.getTailSamples())
             {
-                if (s % 100 == 0)
-                {
-                    allpass[filter].coefficients = coef;
-                    allpass[filter + 1].coefficients = coef;
-                }
-                left = allpass[filter].processSample(left);
-                right = allpass[filter + 1].processSample(right);
+                for (int ch = 0; ch < numChannels; ++ch)
+                    buffer.clear(ch, offset, num);
+
+                continue;
             }
 
-            dataLeft[s] = left;
-            dataRight[s] = right;
+            if constexpr (std::is_same_v<SampleType, float>)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    dispersion.offsetChannels[(size_t)ch] = buffer.getWritePointer(ch, offset);
 
+                extended.process(dispersion.offsetChannels.data(), numChannels, num);
+            }
+            else
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    juce::FloatVectorOperations::convertDoubleToFloat(extendedScratch.getWritePointer(ch), buffer.getReadPointer(ch, offset), num);
+
+                extended.process(extendedScratch.getArrayOfWritePointers(), numChannels, num);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    juce::FloatVectorOperations::convertFloatToDouble(buffer.getWritePointer(ch, offset), extendedScratch.getReadPointer(ch), num);
+            }
+        }
+        else if (inputSilent && hasRungOut(dispersion))
+        {
+            skipCascade(dispersion, num, numStages);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.clear(ch, offset, num);
+        }
+        else
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                dispersion.offsetChannels[(size_t)ch] = buffer.getWritePointer(ch, offset);
+
+            processCascade(dispersion.offsetChannels.data(), numChannels, num, numStages);
         }
     }
 
     fftData.pushNextSampleIntoFifo(buffer);
-    avgValue = 0;
+}
+
+template <typename SampleType>
+void DisburserAudioProcessor::processCascade(SampleType* const* channels, int numChannels, int numSamples, int numStages)
+{
+    auto& oversampler = getDispersion<SampleType>().oversampler;
+    auto factor = oversampler.getFactor();
+    auto* cascadeChannels = channels;
+
+    if (factor > 1)
+    {
+        oversampler.processUp(channels, numChannels, numSamples);
+        cascadeChannels = oversampler.getUpChannels();
+    }
+
+    //Stage count changes crossfade inside the cascade, so moving the knob doesn't pop
+    if (cutoffSmoothed.isSmoothing() || smashSmoothed.isSmoothing())
+    {
+        for (int offset = 0; offset < numSamples; offset += coefficientInterval)
+        {
+            auto num = juce::jmin((int)coefficientInterval, numSamples - offset);
+
+            cutoffSmoothed.skip(num);
+            smashSmoothed.skip(num);
+            updateCoefficients(num * factor);
+
+            runCascades(cascadeChannels, numChannels, offset * factor, num * factor, numStages);
+        }
+    }
+    else
+    {
+        updateCoefficients(0);
+        runCascades(cascadeChannels, numChannels, 0, numSamples * factor, numStages);
+    }
+
+    if (factor > 1)
+        oversampler.processDown(channels, numChannels, numSamples);
+}
+
+template <typename SampleType>
+void DisburserAudioProcessor::runCascades(SampleType* const* channels, int numChannels, int offset, int numSamples, int numStages)
+{
+    constexpr int numLanes = AllpassCascade<SampleType>::numLanes;
+    auto& cascades = getDispersion<SampleType>().cascades;
+
+    //Each group takes the next numLanes channels, the last one may be partly empty
+    std::array<SampleType*, numLanes> group;
+
+    for (size_t g = 0; g < cascades.size(); ++g)
+    {
+        auto first = (int)g * numLanes;
+        auto count = juce::jmin(numLanes, numChannels - first);
+
+        if (count <= 0)
+            break;
+
+        for (int lane = 0; lane < count; ++lane)
+            group[(size_t)lane] = channels[first + lane] + offset;
+
+        cascades[g]->process(group.data(), count, numSamples, numStages);
+    }
+}
+
+template <typename SampleType>
+bool DisburserAudioProcessor::hasRungOut(const Dispersion<SampleType>& dispersion) const
+{
+    auto threshold = (SampleType)silenceThreshold;
+
+    for (auto& cascade : dispersion.cascades)
+        if (!cascade->isSilent(threshold))
+            return false;
+
+    return dispersion.oversampler.isSilent(threshold);
+}
+
+template <typename SampleType>
+void DisburserAudioProcessor::skipCascade(Dispersion<SampleType>& dispersion, int numSamples, int numStages)
+{
+    //Nothing is ringing, so knob moves and stage count changes can land at once instead of ramping
+    cutoffSmoothed.skip(numSamples);
+    smashSmoothed.skip(numSamples);
+    updateCoefficients(0);
+
+    for (auto& cascade : dispersion.cascades)
+    {
+        cascade->reset();
+        cascade->setCoefficients(coefs);
+        cascade->setNumStages(numStages);
+    }
+
+    dispersion.oversampler.reset();
+}
+
+void DisburserAudioProcessor::updateOversampling()
+{
+    auto numOversamplingStages = oversampling->getIndex();
+
+    if (numOversamplingStages == oversamplingStages)
+        return;
+
+    //A switch clears the filter and cascade state, it's a setup choice rather than something to automate
+    oversamplingStages = numOversamplingStages;
+
+    auto retune = [this](auto& dispersion)
+        {
+            dispersion.oversampler.setNumStages(oversamplingStages);
+
+            for (auto& cascade : dispersion.cascades)
+                cascade->setSampleRate(getSampleRate() * getOversamplingFactor());
+        };
+
+    retune(floatDispersion);
+    retune(doubleDispersion);
+
+    oversamplingLatency = floatDispersion.oversampler.getLatencySamples();
+    triggerAsyncUpdate();
+
+    lastSampleRate = 0.0;
+    updateCoefficients(0);
+}
+
+void DisburserAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    //Hosts can set parameters from the audio thread, and building the engines allocates
+    triggerAsyncUpdate();
+}
+
+void DisburserAudioProcessor::handleAsyncUpdate()
+{
+    extended.setActive(engine->getIndex() == 1);
+    updateLatency();
+}
+
+void DisburserAudioProcessor::updateLatency()
+{
+    //The extended engine skips the oversampler, and uniform partitioning adds no latency of its own.
+    //The audio thread swaps over as soon as the engines are active, so that's what's reported.
+    setLatencySamples(extended.isActive() ? 0 : oversamplingLatency.load());
+}
+
+void DisburserAudioProcessor::updateCoefficients(int rampSamples)
+{
+    //Only redesign when something moved, the result goes into the cascade's own storage
+    auto sampleRate = getSampleRate() * getOversamplingFactor();
+    auto cutoffValue = cutoffSmoothed.getCurrentValue();
+    auto smashValue = smashSmoothed.getCurrentValue();
+
+    if (sampleRate <= 0.0)
+        return;
+
+    if (cutoffValue == lastCutoff && smashValue == lastSmash && sampleRate == lastSampleRate)
+        return;
+
+    lastCutoff = cutoffValue;
+    lastSmash = smashValue;
+    lastSampleRate = sampleRate;
+
+    coefs = AllpassCoefficients::make(sampleRate, cutoffValue, smashValue);
+
+    for (auto& cascade : floatDispersion.cascades)
+        cascade->setCoefficients(coefs, rampSamples);
+
+    for (auto& cascade : doubleDispersion.cascades)
+        cascade->setCoefficients(coefs, rampSamples);
 }
 
 //==============================================================================
@@ -240,6 +535,9 @@ juce::AudioProcessorValueTreeState::ParameterLayout DisburserAudioProcessor::cre
     layout.add(std::make_unique<AudioParameterFloat>(juce::ParameterID{"scatter",2}, "Scatter", scatterRange, 0));
     layout.add(std::make_unique<AudioParameterFloat>(juce::ParameterID{"cutoff",2}, "Cutoff", cutoffRange, 200));
     layout.add(std::make_unique<AudioParameterFloat>(juce::ParameterID{"smash",2}, "Smash", smashRange, .71));
+    layout.add(std::make_unique<AudioParameterChoice>(juce::ParameterID{"oversampling",2}, "Oversampling", StringArray{ "Off", "2x", "4x" }, 0));
+    layout.add(std::make_unique<AudioParameterChoice>(juce::ParameterID{"engine",2}, "Engine", StringArray{ "Cascade", "Extended" }, 0));
+    layout.add(std::make_unique<AudioParameterFloat>(juce::ParameterID{"extendedScatter",2}, "Extended Scatter", NormalisableRange<float>(128, 4096, 2, .3f), 512));
 
     return layout;
 }
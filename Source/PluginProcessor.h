@@ -10,11 +10,17 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "Utility/KiTiK_utilityViz.h"
+#include "DSP/AllpassCascade.h"
+#include "DSP/HalfbandOversampler.h"
+#include "DSP/ExtendedDispersion.h"
+#include "Utility/DspLoadMeter.h"
 
 //==============================================================================
 /**
 */
-class DisburserAudioProcessor  : public juce::AudioProcessor
+class DisburserAudioProcessor  : public juce::AudioProcessor,
+                                 private juce::AudioProcessorValueTreeState::Listener,
+                                 private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -30,6 +36,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -58,16 +66,97 @@ public:
 
     FFTData fftData;
 
-private:
+    //Per block timing of processBlock, safe to query from any non-audio thread
+    DspLoadMeter loadMeter;
+
+    //True once the extended engine has a rendered response loaded, or if it isn't in use
+    bool isExtendedReady() const { return engine->getIndex() != 1 || extended.getTailSamples() > 0; }
 
-    int avgValue{ 0 };
-    std::vector<int> scatterValues;
+private:
 
-    std::array<juce::dsp::IIR::Filter<float>, 64> allpasses;
+    //Everything that runs at the host's precision. Both are prepared, the host picks one.
+    template <typename SampleType>
+    struct Dispersion
+    {
+        //One cascade per group of numLanes channels, they all share one design
+        std::vector<std::unique_ptr<AllpassCascade<SampleType>>> cascades;
+        std::vector<SampleType*> offsetChannels;
+
+        //Only the cascade runs at the oversampled rate, the analyzer taps stay at the host's
+        HalfbandOversampler<SampleType> oversampler;
+    };
+
+    template <typename SampleType>
+    Dispersion<SampleType>& getDispersion()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleDispersion;
+        else
+            return floatDispersion;
+    }
+
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType>
+    void processCascade(SampleType* const* channels, int numChannels, int numSamples, int numStages);
+    template <typename SampleType>
+    void runCascades(SampleType* const* channels, int numChannels, int offset, int numSamples, int numStages);
+    template <typename SampleType>
+    bool hasRungOut(const Dispersion<SampleType>& dispersion) const;
+    template <typename SampleType>
+    void skipCascade(Dispersion<SampleType>& dispersion, int numSamples, int numStages);
+
+    void updateCoefficients(int rampSamples);
+    void updateOversampling();
+    void updateLatency(); //message thread, setLatencySamples locks and notifies the host
+    int getOversamplingFactor() const { return 1 << oversamplingStages; }
+
+    //About -140 dB, below the last bit of 24 bit audio. Input and filter state under this count as silence.
+    static constexpr double silenceThreshold = 1.0e-7;
+
+    //Tails past this are reported as this, some hosts treat huge values as infinite
+    static constexpr double maxTailSeconds = 30.0;
+
+    //Exact designs are made this often while a knob is moving, the cascade ramps in between
+    static constexpr int coefficientInterval = 32;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> cutoffSmoothed;
+    juce::SmoothedValue<float> smashSmoothed;
+
+    AllpassCoefficients coefs;
+    float lastCutoff{ -1.f }, lastSmash{ -1.f };
+    double lastSampleRate{ 0.0 };
+
+    Dispersion<float> floatDispersion;
+    Dispersion<double> doubleDispersion;
+    int preparedChannels{ 0 };
+    int oversamplingStages{ 0 };
+    int maxBlockSize{ 0 };
+
+    //Set by the audio thread when the oversampling changes, reported from handleAsyncUpdate
+    std::atomic<int> oversamplingLatency{ 0 };
+
+    //Consecutive input samples under silenceThreshold, for the extended engine's tail
+    int silentSamples{ 0 };
+
+    //The extended engine's convolutions are built and released on the message thread as it's switched,
+    //and latency changes go out from there too
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    //Stage counts past the cascade's reach run as one long convolution instead
+    ExtendedDispersion extended;
+    bool usingExtended{ false };
+
+    //Convolution is float only, so double blocks pass through here on the extended engine
+    juce::AudioBuffer<float> extendedScratch;
 
     juce::AudioParameterFloat* scatter{ nullptr };
     juce::AudioParameterFloat* cutoff{ nullptr };
     juce::AudioParameterFloat* smash{ nullptr };
+    juce::AudioParameterChoice* oversampling{ nullptr };
+    juce::AudioParameterChoice* engine{ nullptr };
+    juce::AudioParameterFloat* extendedScatter{ nullptr };
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DisburserAudioProcessor)
 };
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    DspLoadMeter.cpp
+    Created: 17 Oct 2026 10:04:51pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "DspLoadMeter.h"
+
+DspLoadMeter::DspLoadMeter()
+{
+    for (auto& load : loads)
+        load.store(0.f, std::memory_order_relaxed);
+}
+
+void DspLoadMeter::prepare(double sampleRate)
+{
+    ticksPerSample = sampleRate > 0.0 ? (double)juce::Time::getHighResolutionTicksPerSecond() / sampleRate : 0.0;
+    numWritten = 0;
+}
+
+DspLoadMeter::ScopedTimer::ScopedTimer(DspLoadMeter& m, int n)
+    : meter(m), numSamples(n), start(juce::Time::getHighResolutionTicks())
+{
+}
+
+DspLoadMeter::ScopedTimer::~ScopedTimer()
+{
+    meter.push(juce::Time::getHighResolutionTicks() - start, numSamples);
+}
+
+void DspLoadMeter::push(juce::int64 elapsedTicks, int numSamples)
+{
+    if (numSamples <= 0 || ticksPerSample <= 0.0)
+        return;
+
+    //Single writer, so the count can be read back and bumped without a read-modify-write
+    auto index = numWritten.load(std::memory_order_relaxed);
+    loads[index % windowSize].store((float)((double)elapsedTicks / (ticksPerSample * numSamples)), std::memory_order_relaxed);
+    numWritten.store(index + 1, std::memory_order_release);
+}
+
+DspLoadMeter::Stats DspLoadMeter::getStats()
+{
+    const juce::SpinLock::ScopedLockType lock(readLock);
+
+    auto written = numWritten.load(std::memory_order_acquire);
+    auto count = (int)juce::jmin(written, (juce::uint32)windowSize);
+
+    Stats stats;
+    stats.numBlocks = count;
+
+    if (count == 0)
+        return stats;
+
+    //A slot the audio thread rewrites mid-copy just brings in a newer block, which is fine for a meter
+    double sum = 0.0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        sorted[(size_t)i] = loads[(size_t)i].load(std::memory_order_relaxed);
+        sum += sorted[(size_t)i];
+        stats.max = juce::jmax(stats.max, sorted[(size_t)i]);
+    }
+
+    stats.mean = (float)(sum / count);
+
+    auto rank = sorted.begin() + juce::roundToInt(.99 * (count - 1));
+    std::nth_element(sorted.begin(), rank, sorted.begin() + count);
+    stats.p99 = *rank;
+
+    return stats;
+}
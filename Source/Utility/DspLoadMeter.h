@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    DspLoadMeter.h
+    Created: 17 Oct 2026 10:04:51pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_core/juce_core.h>
+
+//How much of each block's time processBlock used. 1.0 is a block that took as long
+//as it lasts at the host's sample rate, anything past that is an underrun somewhere.
+//
+//The audio thread reads the high resolution clock on the way in and out and writes
+//one float into a ring of the last windowSize blocks. That's two clock reads and one
+//relaxed store, cheap enough to leave on. Readers work the statistics out from a copy
+//of the ring, so the audio thread never sorts, waits or gets skipped for a reader.
+//The ring always holds the newest blocks, the oldest just get overwritten.
+struct DspLoadMeter
+{
+    enum
+    {
+        windowSize = 1024
+    };
+
+    struct Stats
+    {
+        float mean = 0.f, p99 = 0.f, max = 0.f;
+        int numBlocks = 0; //how many of the window's slots hold a block yet
+    };
+
+    DspLoadMeter();
+
+    //Before processing starts, also clears the window
+    void prepare(double sampleRate);
+
+    //Audio thread, times the rest of the enclosing scope
+    struct ScopedTimer
+    {
+        ScopedTimer(DspLoadMeter& meter, int numSamples);
+        ~ScopedTimer();
+
+    private:
+        DspLoadMeter& meter;
+        int numSamples;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    //Any thread but the audio one, over the last windowSize blocks
+    Stats getStats();
+
+private:
+    void push(juce::int64 elapsedTicks, int numSamples);
+
+    double ticksPerSample{ 0.0 };
+
+    std::array<std::atomic<float>, windowSize> loads;
+    std::atomic<juce::uint32> numWritten{ 0 };
+
+    //Reader side, the lock only keeps two readers from sharing the scratch
+    juce::SpinLock readLock;
+    std::array<float, windowSize> sorted;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DspLoadMeter)
+};
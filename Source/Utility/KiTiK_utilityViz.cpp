@@ -12,6 +12,19 @@
 #include "../PluginProcessor.h"
 
 
+    //=======================================Analysis==================================
+    AnalysisThread::AnalysisThread()
+        : juce::TimeSliceThread("KiTiK Analysis")
+    {
+        startThread(juce::Thread::Priority::low);
+    }
+
+    AnalysisThread::~AnalysisThread()
+    {
+        stopThread(1000);
+    }
+    //=======================================Analysis==================================
+
     FFTData::FFTData()
     {
     }
@@ -21,129 +34,585 @@
     }
 
     //=======================================FFTData===================================
-    void FFTData::pushNextSampleIntoFifo(juce::AudioBuffer<float> buffer)
+    void FFTData::pushPreProcessing(const juce::AudioBuffer<float>& buffer)
     {
-        auto* data = buffer.getReadPointer(0);
+        pushPreProcessingImpl(buffer);
+    }
+
+    void FFTData::pushPreProcessing(const juce::AudioBuffer<double>& buffer)
+    {
+        pushPreProcessingImpl(buffer);
+    }
+
+    void FFTData::pushNextSampleIntoFifo(const juce::AudioBuffer<float>& buffer)
+    {
+        pushNextSampleIntoFifoImpl(buffer);
+    }
+
+    void FFTData::pushNextSampleIntoFifo(const juce::AudioBuffer<double>& buffer)
+    {
+        pushNextSampleIntoFifoImpl(buffer);
+    }
+
+    template <typename SampleType>
+    void FFTData::pushPreProcessingImpl(const juce::AudioBuffer<SampleType>& buffer)
+    {
+        if (!preTapEnabled.load(std::memory_order_relaxed))
+            return;
+
+        //Reserve this block's slot now and fill the input half, the output half and
+        //the commit happen in pushNextSampleIntoFifo
+        auto numSamples = juce::jmin(buffer.getNumSamples(), ringFifo.getFreeSpace());
+
+        ringFifo.prepareToWrite(numSamples, pendingStart1, pendingSize1, pendingStart2, pendingSize2);
+        writePending = true;
+
+        copyToRing(1, buffer);
+    }
+
+    template <typename SampleType>
+    void FFTData::pushNextSampleIntoFifoImpl(const juce::AudioBuffer<SampleType>& buffer)
+    {
+        //Audio thread: copy into the preallocated ring, drop what doesn't fit
+        if (!writePending)
+        {
+            auto numSamples = juce::jmin(buffer.getNumSamples(), ringFifo.getFreeSpace());
+            ringFifo.prepareToWrite(numSamples, pendingStart1, pendingSize1, pendingStart2, pendingSize2);
+        }
+
+        copyToRing(0, buffer);
+
+        //Travels with the samples, so a tap switched on mid-stream never exposes an input half nobody wrote
+        memset(ringHasInput + pendingStart1, writePending ? 1 : 0, (size_t)pendingSize1);
+        memset(ringHasInput + pendingStart2, writePending ? 1 : 0, (size_t)pendingSize2);
+
+        ringFifo.finishedWrite(pendingSize1 + pendingSize2);
+        writePending = false;
+    }
+
+    template <typename SampleType>
+    void FFTData::copyToRing(int tap, const juce::AudioBuffer<SampleType>& buffer)
+    {
+        auto* leftData = buffer.getReadPointer(0);
+        auto* rightData = buffer.getNumChannels() > 1 ? buffer.getReadPointer(1) : leftData;
+
+        //The ring and everything after it is float, double blocks are narrowed on the way in
+        auto copy = [](float* dest, const SampleType* source, int numSamples)
+            {
+                if constexpr (std::is_same_v<SampleType, float>)
+                    memcpy(dest, source, sizeof(float) * (size_t)numSamples);
+                else
+                    for (int i = 0; i < numSamples; ++i)
+                        dest[i] = (float)source[i];
+            };
+
+        copy(ring[tap][0] + pendingStart1, leftData, pendingSize1);
+        copy(ring[tap][1] + pendingStart1, rightData, pendingSize1);
+        copy(ring[tap][0] + pendingStart2, leftData + pendingSize1, pendingSize2);
+        copy(ring[tap][1] + pendingStart2, rightData + pendingSize1, pendingSize2);
+    }
+
+    void FFTData::prepare(float sr)
+    {
+        sampleRate = sr;
+    }
+
+    void FFTData::setOrder(int newOrder)
+    {
+        order = juce::jlimit((int)minOrder, (int)maxOrder, newOrder);
+    }
+
+    void FFTData::setOverlap(float newOverlap)
+    {
+        overlap = juce::jlimit(0.f, .9375f, newOverlap);
+    }
+
+    void FFTData::setPreTapEnabled(bool shouldBeEnabled)
+    {
+        preTapEnabled = shouldBeEnabled;
+    }
+
+    int FFTData::getOrder() const
+    {
+        return order.load();
+    }
+
+    float FFTData::getOverlap() const
+    {
+        return overlap.load();
+    }
+
+    bool FFTData::isPreTapEnabled() const
+    {
+        return preTapEnabled.load();
+    }
+
+    void FFTData::allocateAnalysisBuffers()
+    {
+        fftData.assign(2 * maxFFTSize, 0.f);
+        history.assign((size_t)numTaps * numStreams * maxFFTSize, 0.f);
+        midSide.assign(2 * maxFFTSize, 0.f);
+        scopeFrames.assign((size_t)3 * numLayers * numStreams * maxScopeSize, -72.f);
+    }
+
+    void FFTData::updateOrder()
+    {
+        auto wanted = order.load();
+
+        if (wanted == currentOrder)
+            return;
+
+        //Only the transform objects depend on the size, and they're built here on the worker
+        currentOrder = wanted;
+        fftSize = 1 << currentOrder;
+        forwardFFT = std::make_unique<juce::dsp::FFT>(currentOrder);
+        window = std::make_unique<juce::dsp::WindowingFunction<float>>((size_t)fftSize, juce::dsp::WindowingFunction<float>::hann);
+        samplesSinceFrame = 0;
+    }
+
+    float* FFTData::getHistory(int tap, int stream)
+    {
+        return history.data() + ((size_t)tap * numStreams + (size_t)stream) * maxFFTSize;
+    }
+
+    float* FFTData::getBackFrame(int layer, int stream)
+    {
+        return scopeFrames.data() + (((size_t)backIndex * numLayers + (size_t)layer) * numStreams + (size_t)stream) * maxScopeSize;
+    }
 
-        for (int i = 0; i < buffer.getNumSamples(); i++)
+    int FFTData::useTimeSlice()
+    {
+        if (history.empty())
+            allocateAnalysisBuffers();
+
+        updateOrder();
+
+        auto hop = juce::jmax(1, juce::roundToInt(fftSize * (1.f - overlap.load())));
+        auto published = false;
+
+        while (ringFifo.getNumReady() > 0)
         {
-            if (fifoIndex == fftSize)
+            auto num = juce::jmin(juce::jmax(1, hop - samplesSinceFrame), ringFifo.getNumReady());
+
             {
-                if (!nextFFTBlockReady)
+                const auto scope = ringFifo.read(num);
+                capture(scope.startIndex1, scope.blockSize1);
+                capture(scope.startIndex2, scope.blockSize2);
+            }
+
+            samplesSinceFrame += num;
+
+            if (samplesSinceFrame >= hop)
+            {
+                samplesSinceFrame = 0;
+
+                //If we've fallen behind, only the newest frame is worth computing
+                if (ringFifo.getNumReady() < hop)
                 {
-                    juce::zeromem(fftData, sizeof(fftData));
-                    memcpy(fftData, fifo, sizeof(fifo));
-                    nextFFTBlockReady = true;
+                    computeFrame();
+                    published = true;
                 }
+            }
+        }
+
+        return published ? 5 : 15;
+    }
+
+    void FFTData::capture(int ringStart, int numSamples)
+    {
+        if (numSamples <= 0)
+            return;
+
+        auto wantInput = preTapEnabled.load();
+
+        if (wantInput && !capturingInput)
+            for (int stream = 0; stream < numStreams; ++stream)
+                juce::zeromem(getHistory(1, stream), sizeof(float) * maxFFTSize);
+
+        capturingInput = wantInput;
 
-                fifoIndex = 0;
+        auto numTapsToCapture = wantInput ? (int)numTaps : 1;
+        auto* m = midSide.data();
+        auto* sd = midSide.data() + maxFFTSize;
+
+        for (int tap = 0; tap < numTapsToCapture; ++tap)
+        {
+            auto* l = ring[tap][0] + ringStart;
+            auto* r = ring[tap][1] + ringStart;
+
+            //Slots written before the audio thread saw the tap go on count as silence. fftData
+            //is free to borrow here, it's only used while a frame is computed.
+            if (tap == 1 && std::find(ringHasInput + ringStart, ringHasInput + ringStart + numSamples, false) != ringHasInput + ringStart + numSamples)
+            {
+                auto* cleanL = fftData.data();
+                auto* cleanR = fftData.data() + maxFFTSize;
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    cleanL[i] = ringHasInput[ringStart + i] ? l[i] : 0.f;
+                    cleanR[i] = ringHasInput[ringStart + i] ? r[i] : 0.f;
+                }
+
+                l = cleanL;
+                r = cleanR;
             }
 
-            fifo[fifoIndex++] = data[i];
+            //mid = (l + r) / 2, side = (l - r) / 2
+            juce::FloatVectorOperations::add(m, l, r, numSamples);
+            juce::FloatVectorOperations::multiply(m, .5f, numSamples);
+            juce::FloatVectorOperations::subtract(sd, l, r, numSamples);
+            juce::FloatVectorOperations::multiply(sd, .5f, numSamples);
+
+            appendToHistory(getHistory(tap, left), l, numSamples);
+            appendToHistory(getHistory(tap, right), r, numSamples);
+            appendToHistory(getHistory(tap, mid), m, numSamples);
+            appendToHistory(getHistory(tap, side), sd, numSamples);
         }
+
+        historyWrite = (historyWrite + numSamples) & (maxFFTSize - 1);
     }
-    void FFTData::prepare(float sr)
+
+    void FFTData::appendToHistory(float* h, const float* samples, int numSamples)
     {
-        sampleRate = sr;
+        //Each hop only writes what's new, so the cost follows the hop rather than maxFFTSize
+        auto first = juce::jmin(numSamples, maxFFTSize - historyWrite);
+        memcpy(h + historyWrite, samples, sizeof(float) * (size_t)first);
+        memcpy(h, samples + first, sizeof(float) * (size_t)(numSamples - first));
+    }
+
+    int FFTData::getHistoryStart(int numSamples) const
+    {
+        return (historyWrite - numSamples) & (maxFFTSize - 1);
+    }
+
+    void FFTData::readHistory(const float* h, float* dest, int numSamples) const
+    {
+        //The newest numSamples, unwrapped
+        auto start = getHistoryStart(numSamples);
+        auto first = juce::jmin(numSamples, maxFFTSize - start);
+        memcpy(dest, h + start, sizeof(float) * (size_t)first);
+        memcpy(dest + first, h, sizeof(float) * (size_t)(numSamples - first));
+    }
+
+    void FFTData::computeFrame()
+    {
+        float min_dB = -72.f;
+
+        int numBins = fftSize / 2;
+        auto numTapsToAnalyse = preTapEnabled.load() ? (int)numTaps : 1;
+
+        //Don't publish a stream of identical floor-level frames, readers stop repainting instead
+        auto silent = isWindowSilent(numTapsToAnalyse);
+
+        if (silent && publishedSilentFrame && publishedNumBins == numBins && publishedNumTaps == numTapsToAnalyse)
+            return;
+
+        publishedSilentFrame = silent;
+        publishedNumBins = numBins;
+        publishedNumTaps = numTapsToAnalyse;
+
+        //Every stream of every tap goes through the same window and transform back to back
+        for (int tap = 0; tap < numTapsToAnalyse; ++tap)
+        {
+            for (int stream = 0; stream < numStreams; ++stream)
+            {
+                auto* work = fftData.data();
+
+                juce::zeromem(work, sizeof(float) * 2 * (size_t)fftSize);
+                readHistory(getHistory(tap, stream), work, fftSize);
+
+                window->multiplyWithWindowingTable(work, (size_t)fftSize);
+                forwardFFT->performFrequencyOnlyForwardTransform(work);
+
+                auto* scopeData = getBackFrame(tap == 0 ? output : input, stream);
+
+                //normalize the fft values and convert them to decibels
+                for (int i = 0; i < numBins; ++i)
+                {
+                    auto v = work[i];
+
+                    if (!std::isinf(v) && !std::isnan(v))
+                    {
+                        v /= float(numBins);
+                    }
+                    else
+                    {
+                        v = 0.f;
+                    }
+
+                    scopeData[i] = juce::Decibels::gainToDecibels(v, min_dB);
+                }
+            }
+        }
+
+        if (numTapsToAnalyse > 1)
+        {
+            for (int stream = 0; stream < numStreams; ++stream)
+                juce::FloatVectorOperations::subtract(getBackFrame(difference, stream), getBackFrame(output, stream), getBackFrame(input, stream), numBins);
+        }
+
+        frameNumBins[backIndex] = numBins;
+        frameSampleRate[backIndex] = sampleRate.load();
+
+        backIndex = middleIndex.exchange(backIndex | newFrameFlag) & ~newFrameFlag;
+    }
+
+    bool FFTData::isWindowSilent(int numTapsToAnalyse)
+    {
+        //Well under the -72 dB floor the analyzer draws at
+        constexpr float silenceThreshold = 1.0e-4f;
+
+        auto start = getHistoryStart(fftSize);
+        auto first = juce::jmin(fftSize, maxFFTSize - start);
+
+        for (int tap = 0; tap < numTapsToAnalyse; ++tap)
+        {
+            for (int stream : { left, right })
+            {
+                auto* h = getHistory(tap, stream);
+                auto range = juce::FloatVectorOperations::findMinAndMax(h + start, first);
+
+                if (first < fftSize)
+                    range = range.getUnionWith(juce::FloatVectorOperations::findMinAndMax(h, fftSize - first));
+
+                if (juce::jmax(-range.getStart(), range.getEnd()) > silenceThreshold)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool FFTData::hasNewFrame() const
+    {
+        return (middleIndex.load() & newFrameFlag) != 0;
+    }
+
+    bool FFTData::acquireLatestFrame()
+    {
+        if ((middleIndex.load() & newFrameFlag) == 0)
+            return false;
+
+        frontIndex = middleIndex.exchange(frontIndex) & ~newFrameFlag;
+        return true;
+    }
+
+    const float* FFTData::getFrame(int layer, int stream) const
+    {
+        //Only valid once getFrameNumBins() is non zero, before that nothing has been allocated
+        return scopeFrames.data() + (((size_t)frontIndex * numLayers + (size_t)layer) * numStreams + (size_t)stream) * maxScopeSize;
+    }
+
+    int FFTData::getFrameNumBins() const
+    {
+        return frameNumBins[frontIndex];
+    }
+
+    float FFTData::getFrameSampleRate() const
+    {
+        return frameSampleRate[frontIndex];
     }
     //=======================================FFTData===================================
 
     //=======================================FFT=======================================
     FFTComp::FFTComp(FFTData& d)
-        : data(d) {}
+        : data(d)
+    {
+        analysisThread->addTimeSliceClient(&data);
+    }
 
-    FFTComp::~FFTComp() {}
+    FFTComp::~FFTComp()
+    {
+        analysisThread->removeTimeSliceClient(&data);
+        data.setPreTapEnabled(false);
+    }
 
     void FFTComp::paint(juce::Graphics& g)
     {
-        auto bounds = getLocalBounds();
-        float width = bounds.getWidth();
-        float height = bounds.getHeight();
+        //Analysis happens on the worker, paint only picks up the newest finished frame
+        data.acquireLatestFrame();
+        auto numBins = data.getFrameNumBins();
+
+        if (numBins != mappedNumBins || data.getFrameSampleRate() != mappedSampleRate)
+            updateBinMapping(numBins, data.getFrameSampleRate());
+
+        if (numBins == 0)
+            return;
 
-        if (data.nextFFTBlockReady)
+        for (int stream = 0; stream < FFTData::numStreams; ++stream)
         {
-            drawNextFrame(data);
-            data.nextFFTBlockReady = false;
-        }
+            if ((visibleStreams & (1 << stream)) == 0)
+                continue;
+
+            auto colour = getStreamColour(stream);
+
+            if (displayMode == difference)
+            {
+                drawDifference(g, data.getFrame(FFTData::difference, stream), colour);
+                continue;
+            }
 
-        g.setColour(juce::Colours::red);
+            if (displayMode == inputAndOutput)
+                drawSpectrum(g, data.getFrame(FFTData::input, stream), colour.withMultipliedAlpha(.35f));
 
-        juce::Path p;
+            drawSpectrum(g, data.getFrame(FFTData::output, stream), colour);
+        }
+    }
+
+    void FFTComp::drawSpectrum(juce::Graphics& g, const float* scopeData, juce::Colour colour)
+    {
+        float height = getHeight();
+        auto point = height / 2;
+        auto numColumns = (int)columnStartBin.size() - 1;
 
-        p.startNewSubPath(0, height);
+        bars.clear();
 
-        for (int i = 1; i < data.scopeSize; ++i)
+        for (int x = 0; x < numColumns; ++x)
         {
-            auto point = height / 2;
+            auto start = columnStartBin[(size_t)x];
+            auto count = columnStartBin[(size_t)x + 1] - start;
 
-            float binFreq = i * data.sampleRate / data.fftSize;
-            auto normalizedX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-            auto binX = std::floor(normalizedX * width);
+            if (count <= 0)
+                continue;
 
-            if (data.scopeData[i] > -24.f)
+            auto level = juce::FloatVectorOperations::findMaximum(scopeData + start, count);
+
+            if (level > -24.f)
             {
-                auto length = juce::jmap(data.scopeData[i], -24.f, 0.f, height / 16, height / 2);
-                auto top = point - length;
-                auto bottom = point + length;
-                g.fillRect(juce::Rectangle<float>((float)binX, top, 1.0f, bottom - top));
+                auto length = juce::jmap(level, -24.f, 0.f, height / 16, height / 2);
+                bars.addWithoutMerging(juce::Rectangle<float>((float)x, point - length, 1.0f, length * 2));
             }
         }
 
-        auto roundP = p.createPathWithRoundedCorners(10);
+        g.setColour(colour);
+        g.fillRectList(bars);
+    }
+
+    void FFTComp::drawDifference(juce::Graphics& g, const float* diffData, juce::Colour colour)
+    {
+        //Output over input in dB, up from the centre line for boosts, down for cuts, +-12 dB full scale
+        float height = getHeight();
+        auto point = height / 2;
+        auto numColumns = (int)columnStartBin.size() - 1;
 
-        g.strokePath(roundP, juce::PathStrokeType(1));
+        bars.clear();
+
+        for (int x = 0; x < numColumns; ++x)
+        {
+            auto start = columnStartBin[(size_t)x];
+            auto count = columnStartBin[(size_t)x + 1] - start;
+
+            if (count <= 0)
+                continue;
+
+            auto range = juce::FloatVectorOperations::findMinAndMax(diffData + start, count);
+            auto level = std::abs(range.getStart()) > std::abs(range.getEnd()) ? range.getStart() : range.getEnd();
+            auto length = juce::jmap(juce::jlimit(-12.f, 12.f, level), -12.f, 12.f, -point, point);
+
+            if (std::abs(length) >= .5f)
+                bars.addWithoutMerging(juce::Rectangle<float>((float)x, juce::jmin(point, point - length), 1.0f, std::abs(length)));
+        }
+
+        g.setColour(colour);
+        g.fillRectList(bars);
+    }
+
+    void FFTComp::setDisplayMode(DisplayMode newMode)
+    {
+        displayMode = newMode;
+        data.setPreTapEnabled(displayMode != outputOnly);
+        repaint();
     }
 
-    void FFTComp::resized() {}
+    juce::Colour FFTComp::getStreamColour(int stream)
+    {
+        switch (stream)
+        {
+        case FFTData::left: return juce::Colours::red.withAlpha(.75f);
+        case FFTData::right: return juce::Colour(64u, 194u, 230u).withAlpha(.75f);
+        case FFTData::mid: return juce::Colours::whitesmoke.withAlpha(.75f);
+        default: return juce::Colours::grey.withAlpha(.75f);
+        }
+    }
 
-    void FFTComp::drawNextFrame(FFTData& data)
+    void FFTComp::resized()
     {
-        data.window.multiplyWithWindowingTable(data.fftData, data.fftSize);
-        data.forwardFFT.performFrequencyOnlyForwardTransform(data.fftData);
+        updateBinMapping(mappedNumBins, mappedSampleRate);
+    }
 
-        float min_dB = -72.f;
+    void FFTComp::updateBinMapping(int numBins, float sampleRate)
+    {
+        mappedNumBins = numBins;
+        mappedSampleRate = sampleRate;
+
+        auto width = juce::jmax(0, getWidth());
+        auto fftSize = numBins * 2;
 
-        int numBins = (int)data.fftSize / 2;
+        columnStartBin.assign((size_t)width + 1, 0);
+        bars.ensureStorageAllocated(width);
 
-        //normalize the fft values.
-        for (int i = 0; i < numBins; ++i)
+        //Bin 0 is DC and the log axis starts at 20 Hz. Bins arrive in increasing x order, so
+        //one walk fills in where each column's run starts. Columns no bin lands on get an empty run.
+        auto column = 0;
+        auto lastBin = numBins;
+
+        for (int i = 1; i < numBins; ++i)
         {
-            auto v = data.fftData[i];
+            float binFreq = i * sampleRate / fftSize;
+            auto binX = (int)std::floor(juce::mapFromLog10(binFreq, 20.f, 20000.f) * width);
 
-            if (!std::isinf(v) && !std::isnan(v))
-            {
-                v /= float(numBins);
-            }
-            else
+            if (binX < 0)
+                continue;
+
+            if (binX >= width)
             {
-                v = 0.f;
+                lastBin = i;
+                break;
             }
-            data.fftData[i] = v;
+
+            while (column <= binX)
+                columnStartBin[(size_t)column++] = i;
+        }
+
+        while (column <= width)
+            columnStartBin[(size_t)column++] = lastBin;
+    }
+
+    juce::PopupMenu FFTComp::getSettingsMenu()
+    {
+        juce::PopupMenu resolution, overlap;
+
+        for (int o = FFTData::minOrder; o <= FFTData::maxOrder; ++o)
+        {
+            resolution.addItem(juce::String(1 << o), true, data.getOrder() == o, [this, o]() { data.setOrder(o); });
         }
 
-        //convert them to decibels
-        for (int i = 0; i < numBins; ++i)
+        for (auto amount : { 0.f, .5f, .75f, .875f })
         {
-            data.fftData[i] = juce::Decibels::gainToDecibels(data.fftData[i], min_dB);
+            overlap.addItem(juce::String(amount * 100.f) + "%", true, data.getOverlap() == amount, [this, amount]() { data.setOverlap(amount); });
         }
 
-        for (int i = 0; i < data.scopeSize; i++)
+        juce::StringArray streamNames{ "Left", "Right", "Mid", "Side" };
+        juce::PopupMenu streams;
+
+        for (int stream = 0; stream < FFTData::numStreams; ++stream)
         {
-            data.scopeData[i] = data.fftData[i];
+            auto bit = 1 << stream;
+            streams.addItem(streamNames[stream], true, (visibleStreams & bit) != 0, [this, bit]() { visibleStreams ^= bit; repaint(); });
         }
 
-        //for (int i = 0; i < data.scopeSize; ++i)                         // [3]
-        //{
-        //    auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - (float)i / (float)data.scopeSize) * 0.05f);
-        //    //skewedProportionX =  (std::log10((float)i / (float)data.scopeSize));
-        //    
-        //    auto fftDataIndex = juce::jlimit(0, data.fftSize / 2, (int)(skewedProportionX * (float)data.fftSize * 0.5f));
-        //    auto level = juce::jmap(juce::jlimit(min_dB, max_dB, juce::Decibels::gainToDecibels(data.fftData[fftDataIndex])
-        //        - juce::Decibels::gainToDecibels((float)data.fftSize)),
-        //        min_dB, max_dB, 0.0f, 1.0f);
+        juce::PopupMenu display;
+        display.addItem("Output", true, displayMode == outputOnly, [this]() { setDisplayMode(outputOnly); });
+        display.addItem("Input and Output", true, displayMode == inputAndOutput, [this]() { setDisplayMode(inputAndOutput); });
+        display.addItem("Difference", true, displayMode == difference, [this]() { setDisplayMode(difference); });
+
+        juce::PopupMenu menu;
+        menu.addSubMenu("Display", display);
+        menu.addSubMenu("Channels", streams);
+        menu.addSubMenu("Resolution", resolution);
+        menu.addSubMenu("Overlap", overlap);
 
-        //    data.scopeData[i] = level;                                   // [4]
-        //}
+        return menu;
     }
 
     //=======================================FFT=======================================
@@ -151,50 +620,214 @@
     //=======================================Oscilloscope==============================
 
     OscilloscopeComp::OscilloscopeComp(OscilloscopeData& d)
-        : data(d) {}
+        : data(d)
+    {
+        analysisThread->addTimeSliceClient(&data);
+    }
 
-    OscilloscopeComp::~OscilloscopeComp() {}
+    OscilloscopeComp::~OscilloscopeComp()
+    {
+        analysisThread->removeTimeSliceClient(&data);
+    }
 
     void OscilloscopeComp::paint(juce::Graphics& g)
     {
         auto bounds = getLocalBounds();
         auto height = bounds.getHeight();
-        float width = bounds.getWidth();
+        auto width = (int)columnMin.size();
 
-        g.setColour(juce::Colours::black);
+        if (width == 0)
+            return;
+
+        data.acquireLatestFrame();
+
+        //O(pixels): each column reads its min and max straight out of the pyramid
+        auto samplesPerPixel = (float)OscilloscopeData::windowSize / (float)width;
+
+        for (int x = 0; x < width; x++)
+        {
+            auto start = (int)(x * samplesPerPixel);
+            auto end = juce::jmax(start + 1, (int)((x + 1) * samplesPerPixel));
+            auto range = data.getMinMax(start, end);
 
+            columnMin[(size_t)x] = juce::jmap(range.getStart(), -1.f, 1.f, (float)height, 0.f);
+            columnMax[(size_t)x] = juce::jmap(range.getEnd(), -1.f, 1.f, (float)height, 0.f);
+        }
+
+        //Top edge left to right, bottom edge back again, so the trace is one filled shape
         juce::Path path;
+        path.preallocateSpace(width * 6 + 4);
+        path.startNewSubPath(0, columnMax[0]);
+
+        for (int x = 1; x < width; x++)
+            path.lineTo((float)x, columnMax[(size_t)x]);
+
+        for (int x = width - 1; x >= 0; x--)
+            path.lineTo((float)x, columnMin[(size_t)x] + 1.f);
 
-        path.startNewSubPath(0, height / 2);
+        path.closeSubPath();
 
-        auto readPointer = data.oscBuffer.getReadPointer(0);
-        auto size = data.oscBuffer.getNumSamples();
+        g.setColour(juce::Colours::black);
+        g.fillPath(path);
+    }
 
-        auto ratio = size / width;
+    void OscilloscopeComp::resized()
+    {
+        columnMin.assign((size_t)juce::jmax(0, getWidth()), 0.f);
+        columnMax.assign((size_t)juce::jmax(0, getWidth()), 0.f);
+    }
 
-        for (int point = 0; point < size; point += ratio)
+    OscilloscopeData::OscilloscopeData()
+    {
+        juce::zeromem(history, sizeof(history));
+        juce::zeromem(frames, sizeof(frames));
+
+        levelOffset[0] = 0;
+        auto offset = 0;
+
+        for (int level = 1; level < numLevels; level++)
         {
-            audioPoints.push_back(readPointer[point]);
+            levelOffset[level] = offset;
+            offset += windowSize >> level;
         }
+    }
+
+    OscilloscopeData::~OscilloscopeData() {}
+
+    void OscilloscopeData::setBuffer(const juce::AudioBuffer<float>& buffer)
+    {
+        auto* data = buffer.getReadPointer(0);
+        auto numSamples = juce::jmin(buffer.getNumSamples(), ringFifo.getFreeSpace());
+
+        const auto scope = ringFifo.write(numSamples);
+
+        if (scope.blockSize1 > 0)
+            memcpy(ring + scope.startIndex1, data, sizeof(float) * (size_t)scope.blockSize1);
+
+        if (scope.blockSize2 > 0)
+            memcpy(ring + scope.startIndex2, data + scope.blockSize1, sizeof(float) * (size_t)scope.blockSize2);
+    }
+
+    void OscilloscopeData::setTriggerEnabled(bool shouldTrigger)
+    {
+        triggerEnabled = shouldTrigger;
+    }
 
-        for (int i = 0; i < size; i++)
+    int OscilloscopeData::useTimeSlice()
+    {
+        while (ringFifo.getNumReady() > 0)
         {
+            auto num = juce::jmin(ringFifo.getNumReady(), (int)historySize);
+            const auto scope = ringFifo.read(num);
+
+            for (auto [start, size] : { std::pair<int, int>{ scope.startIndex1, scope.blockSize1 }, { scope.startIndex2, scope.blockSize2 } })
+            {
+                if (size <= 0)
+                    continue;
 
-            auto point = juce::jmap(readPointer[i], -1.f, 1.f, (float)height, 0.f);
-            path.lineTo(i, point);
+                memmove(history, history + size, sizeof(float) * (size_t)(historySize - size));
+                memcpy(history + historySize - size, ring + start, sizeof(float) * (size_t)size);
+                haveNewSamples = true;
+            }
         }
 
-        g.strokePath(path, juce::PathStrokeType(1));
+        if (!haveNewSamples)
+            return 15;
+
+        haveNewSamples = false;
+        buildFrame();
+
+        return 15;
     }
 
-    void OscilloscopeComp::resized() {}
+    void OscilloscopeData::buildFrame()
+    {
+        auto start = (int)(historySize - windowSize);
+
+        //Latest rising zero crossing that still leaves a whole window after it
+        if (triggerEnabled.load())
+        {
+            for (int i = historySize - windowSize; i > 0; i--)
+            {
+                if (history[i - 1] < 0.f && history[i] >= 0.f)
+                {
+                    start = i;
+                    break;
+                }
+            }
+        }
 
-    OscilloscopeData::OscilloscopeData() {}
+        auto& frame = frames[backIndex];
+        memcpy(frame.samples, history + start, sizeof(frame.samples));
 
-    OscilloscopeData::~OscilloscopeData() {}
+        //Level 1 from the samples, every level after from the one before it
+        auto* prevMin = frame.samples;
+        auto* prevMax = frame.samples;
+
+        for (int level = 1; level < numLevels; level++)
+        {
+            auto* levelMin = frame.minLevels + levelOffset[level];
+            auto* levelMax = frame.maxLevels + levelOffset[level];
+            auto size = windowSize >> level;
+
+            for (int i = 0; i < size; i++)
+            {
+                levelMin[i] = juce::jmin(prevMin[2 * i], prevMin[2 * i + 1]);
+                levelMax[i] = juce::jmax(prevMax[2 * i], prevMax[2 * i + 1]);
+            }
+
+            prevMin = levelMin;
+            prevMax = levelMax;
+        }
+
+        backIndex = middleIndex.exchange(backIndex | newFrameFlag) & ~newFrameFlag;
+    }
+
+    bool OscilloscopeData::acquireLatestFrame()
+    {
+        if ((middleIndex.load() & newFrameFlag) == 0)
+            return false;
+
+        frontIndex = middleIndex.exchange(frontIndex) & ~newFrameFlag;
+        return true;
+    }
 
-    void OscilloscopeData::setBuffer(juce::AudioBuffer<float> buffer)
+    juce::Range<float> OscilloscopeData::getMinMax(int start, int end) const
     {
-        oscBuffer.setSize(2, buffer.getNumSamples());
-        oscBuffer = buffer;
+        auto& frame = frames[frontIndex];
+
+        start = juce::jlimit(0, (int)windowSize - 1, start);
+        end = juce::jlimit(start + 1, (int)windowSize, end);
+
+        auto level = 0;
+        while (level + 1 < numLevels && (2 << level) <= end - start)
+            level++;
+
+        if (level == 0)
+        {
+            auto lo = frame.samples[start], hi = lo;
+
+            for (int i = start + 1; i < end; i++)
+            {
+                lo = juce::jmin(lo, frame.samples[i]);
+                hi = juce::jmax(hi, frame.samples[i]);
+            }
+
+            return { lo, hi };
+        }
+
+        auto* levelMin = frame.minLevels + levelOffset[level];
+        auto* levelMax = frame.maxLevels + levelOffset[level];
+        auto first = start >> level;
+        auto last = (end - 1) >> level;
+
+        auto lo = levelMin[first], hi = levelMax[first];
+
+        for (int i = first + 1; i <= last; i++)
+        {
+            lo = juce::jmin(lo, levelMin[i]);
+            hi = juce::jmax(hi, levelMax[i]);
+        }
+
+        return { lo, hi };
     }
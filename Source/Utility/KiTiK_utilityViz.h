@@ -12,31 +12,136 @@
 #include <juce_dsp/juce_dsp.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
-    struct FFTData
+    //One low priority worker shared by every open editor in the process
+    struct AnalysisThread : juce::TimeSliceThread
+    {
+        AnalysisThread();
+        ~AnalysisThread() override;
+    };
+
+    struct FFTData : juce::TimeSliceClient
     {
         FFTData();
-        ~FFTData();
-        void pushNextSampleIntoFifo(juce::AudioBuffer<float> buffer);
+        ~FFTData() override;
+
+        //Audio thread. The pre tap is optional, when it's on call pushPreProcessing at the top of
+        //processBlock and pushNextSampleIntoFifo at the bottom, both land in the same ring slot.
+        void pushPreProcessing(const juce::AudioBuffer<float>& buffer);
+        void pushPreProcessing(const juce::AudioBuffer<double>& buffer);
+        void pushNextSampleIntoFifo(const juce::AudioBuffer<float>& buffer);
+        void pushNextSampleIntoFifo(const juce::AudioBuffer<double>& buffer);
         void prepare(float);
+
+        //Safe from any thread, the worker picks the change up before its next frame
+        void setOrder(int);
+        void setOverlap(float);
+        void setPreTapEnabled(bool);
+        int getOrder() const;
+        float getOverlap() const;
+        bool isPreTapEnabled() const;
+
+        int useTimeSlice() override;
+
+        //Reader side, returns true if a newer frame was swapped in since the last call
+        bool acquireLatestFrame();
+        //Cheap check for a repaint scheduler, doesn't swap anything
+        bool hasNewFrame() const;
+        const float* getFrame(int layer, int stream) const;
+        int getFrameNumBins() const;
+        float getFrameSampleRate() const;
+
+        enum
+        {
+            minOrder = 9,
+            maxOrder = 14,
+            defaultOrder = 12
+        };
+
+        enum Stream
+        {
+            left,
+            right,
+            mid,
+            side,
+            numStreams
+        };
+
+        //output and input are dB spectra, difference is output minus input in dB
+        enum Layer
+        {
+            output,
+            input,
+            difference,
+            numLayers
+        };
+
         friend class FFTComp;
 
     protected:
 
         enum
         {
-            fftOrder = 12,
-            fftSize = 1 << fftOrder,
-            scopeSize = fftSize
+            maxFFTSize = 1 << maxOrder,
+            maxScopeSize = maxFFTSize / 2,
+            ringSize = maxFFTSize,
+            numTaps = 2 //output, input
         };
 
-        juce::dsp::FFT forwardFFT{ fftOrder };
-        juce::dsp::WindowingFunction<float> window{ fftSize, juce::dsp::WindowingFunction<float>::hann };
-        float fftData[2 * fftSize];
-        float scopeData[scopeSize];
-        float fifo[fftSize];
-        int fifoIndex = 0;
-        bool nextFFTBlockReady = false;
-        float sampleRate;
+        template <typename SampleType> void pushPreProcessingImpl(const juce::AudioBuffer<SampleType>& buffer);
+        template <typename SampleType> void pushNextSampleIntoFifoImpl(const juce::AudioBuffer<SampleType>& buffer);
+        template <typename SampleType> void copyToRing(int tap, const juce::AudioBuffer<SampleType>& buffer);
+        void allocateAnalysisBuffers();
+        void capture(int ringStart, int numSamples);
+        void appendToHistory(float* history, const float* samples, int numSamples);
+        void readHistory(const float* history, float* dest, int numSamples) const;
+        int getHistoryStart(int numSamples) const;
+        void computeFrame();
+        bool isWindowSilent(int numTapsToAnalyse);
+        void updateOrder();
+        float* getHistory(int tap, int stream);
+        float* getBackFrame(int layer, int stream);
+
+        //Analysis thread only. Nothing here is allocated until an editor starts the worker,
+        //and it's all sized for maxOrder so changing order doesn't reallocate.
+        std::unique_ptr<juce::dsp::FFT> forwardFFT;
+        std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+        int currentOrder = 0;
+        int fftSize = 0;
+        std::vector<float> fftData, history, midSide;
+        //Every history is a ring of maxFFTSize written in step, so one write index covers them all
+        int historyWrite = 0;
+        int samplesSinceFrame = 0;
+        bool frameHasInput = false;
+        //Once one silent frame has gone out there's nothing new to show until the signal returns
+        bool publishedSilentFrame = false;
+        //Input history is only kept while the pre tap is on, it starts from silence each time it comes back
+        bool capturingInput = false;
+        int publishedNumBins = 0, publishedNumTaps = 0;
+
+        std::atomic<float> sampleRate{ 44100.f };
+        std::atomic<int> order{ defaultOrder };
+        std::atomic<float> overlap{ .75f };
+        std::atomic<bool> preTapEnabled{ false };
+
+        //Single producer (audio thread), single consumer (analysis thread), wait-free on both sides.
+        //Only left and right of each tap go through here, mid and side are derived on the worker.
+        juce::AbstractFifo ringFifo{ ringSize };
+        float ring[numTaps][2][ringSize];
+        //Whether the pre tap wrote each ring slot's input half, set by the audio thread with the samples.
+        //The worker reads this rather than preTapEnabled, which may have flipped since.
+        bool ringHasInput[ringSize] = {};
+        int pendingStart1 = 0, pendingSize1 = 0, pendingStart2 = 0, pendingSize2 = 0;
+        bool writePending = false;
+
+        //Triple buffered magnitude frames: the worker fills back, the reader owns front,
+        //and they swap through middle, which carries a flag when it holds a new frame
+        enum { newFrameFlag = 4 };
+        std::vector<float> scopeFrames;
+        int frameNumBins[3] = { 0, 0, 0 };
+        float frameSampleRate[3] = { 44100.f, 44100.f, 44100.f };
+        int backIndex = 0;
+        int frontIndex = 2;
+        std::atomic<int> middleIndex{ 1 };
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FFTData)
     };
@@ -48,24 +153,100 @@
 
         void paint(juce::Graphics& g) override;
         void resized() override;
-        void drawNextFrame(FFTData& data);
+        juce::PopupMenu getSettingsMenu();
+
+        enum DisplayMode
+        {
+            outputOnly,
+            inputAndOutput,
+            difference
+        };
+
+        void setDisplayMode(DisplayMode);
 
     private:
+        void updateBinMapping(int numBins, float sampleRate);
+        void drawSpectrum(juce::Graphics& g, const float* scopeData, juce::Colour colour);
+        void drawDifference(juce::Graphics& g, const float* diffData, juce::Colour colour);
+        static juce::Colour getStreamColour(int stream);
+
         FFTData& data;
+        juce::SharedResourcePointer<AnalysisThread> analysisThread;
+
+        //First bin of every pixel column (plus one past the end), rebuilt on resize or
+        //when the frame layout changes. Bins landing on the same column get reduced to one bar.
+        std::vector<int> columnStartBin;
+        juce::RectangleList<float> bars;
+        int mappedNumBins = 0;
+        float mappedSampleRate = 0.f;
+
+        //Bit per FFTData::Stream
+        int visibleStreams = (1 << FFTData::left) | (1 << FFTData::right);
+        DisplayMode displayMode = outputOnly;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FFTComp)
     };
 
-    struct OscilloscopeData
+    struct OscilloscopeData : juce::TimeSliceClient
     {
         OscilloscopeData();
-        ~OscilloscopeData();
+        ~OscilloscopeData() override;
+
+        //Audio thread, copies the first channel into a preallocated ring and never blocks
+        void setBuffer(const juce::AudioBuffer<float>& buffer);
+
+        //Start each frame on a rising zero crossing, worked out on the analysis thread
+        void setTriggerEnabled(bool);
+
+        int useTimeSlice() override;
+
+        //Reader side, returns true if a newer frame was swapped in since the last call
+        bool acquireLatestFrame();
+
+        //Min and max of the newest frame over [start, end) in samples, using the coarsest
+        //pyramid level that still fits so each call only touches a couple of entries
+        juce::Range<float> getMinMax(int start, int end) const;
+
+        enum
+        {
+            windowSize = 2048,
+            numLevels = 12, //log2(windowSize) + 1
+            historySize = windowSize * 2,
+            ringSize = windowSize * 4
+        };
 
-        void setBuffer(juce::AudioBuffer<float> buffer);
         friend class OscilloscopeComp;
 
     protected:
-        juce::AudioBuffer<float> oscBuffer;
+        void buildFrame();
+
+        //Single producer (audio thread), single consumer (analysis thread)
+        juce::AbstractFifo ringFifo{ ringSize };
+        float ring[ringSize];
+
+        //Analysis thread only
+        float history[historySize];
+        bool haveNewSamples = false;
+
+        std::atomic<bool> triggerEnabled{ true };
+
+        //Level 0 is the window itself, level n > 0 holds min and max over blocks of 2^n samples
+        //and lives at levelOffset[n] in minLevels and maxLevels
+        struct Frame
+        {
+            float samples[windowSize];
+            float minLevels[windowSize];
+            float maxLevels[windowSize];
+        };
+
+        int levelOffset[numLevels];
+
+        //Triple buffered like FFTData
+        enum { newFrameFlag = 4 };
+        Frame frames[3];
+        int backIndex = 0;
+        int frontIndex = 2;
+        std::atomic<int> middleIndex{ 1 };
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscilloscopeData)
 
@@ -82,8 +263,10 @@
     private:
 
         OscilloscopeData& data;
+        juce::SharedResourcePointer<AnalysisThread> analysisThread;
 
-        std::vector<float> audioPoints;
+        //One min and max per pixel column, sized on resize
+        std::vector<float> columnMin, columnMax;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscilloscopeComp)
     };
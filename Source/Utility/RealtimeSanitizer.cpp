@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+    RealtimeSanitizer.cpp
+    Created: 17 Oct 2026 9:26:18pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#include "RealtimeSanitizer.h"
+
+#if DISBURSER_RT_SANITIZER
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <unordered_set>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+#if JUCE_LINUX
+//glibc's own entry points, so the replacements below can reach the real allocator
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+#endif
+
+namespace
+{
+    //Plain values, so touching them from inside malloc never allocates or runs an initialiser
+    thread_local int realtimeDepth = 0;
+    thread_local bool reporting = false;
+
+    std::atomic<int> numViolations{ 0 };
+
+    void report(const char* call)
+    {
+        if (realtimeDepth == 0 || reporting)
+            return;
+
+        //Anything the report itself allocates or locks goes straight through, including
+        //freeing the backtrace, so everything here is gone before the flag drops again
+        reporting = true;
+        ++numViolations;
+
+        {
+            auto backtrace = juce::SystemStats::getStackBacktrace();
+
+            static juce::SpinLock printedLock;
+            static std::unordered_set<juce::int64> printed;
+            bool isNew;
+
+            {
+                const juce::SpinLock::ScopedLockType lock(printedLock);
+                isNew = printed.insert((juce::int64)backtrace.hashCode64()).second;
+            }
+
+            if (isNew)
+                std::fprintf(stderr, "Realtime violation: %s on the audio thread\n%s\n", call, backtrace.toRawUTF8());
+        }
+
+        reporting = false;
+    }
+
+    void* rawAllocate(size_t size)
+    {
+       #if JUCE_LINUX
+        return __libc_malloc(size);
+       #else
+        return std::malloc(size);
+       #endif
+    }
+
+    void rawFree(void* ptr)
+    {
+       #if JUCE_LINUX
+        __libc_free(ptr);
+       #else
+        std::free(ptr);
+       #endif
+    }
+
+    void* rawAllocateAligned(size_t size, size_t alignment)
+    {
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size, alignment);
+       #elif JUCE_LINUX
+        return __libc_memalign(alignment, size);
+       #else
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, juce::jmax(alignment, sizeof(void*)), size) == 0 ? ptr : nullptr;
+       #endif
+    }
+
+    void rawFreeAligned(void* ptr)
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(ptr);
+       #else
+        rawFree(ptr);
+       #endif
+    }
+}
+
+RealtimeSanitizer::Scope::Scope()
+{
+    ++realtimeDepth;
+}
+
+RealtimeSanitizer::Scope::~Scope()
+{
+    --realtimeDepth;
+}
+
+int RealtimeSanitizer::getNumViolations()
+{
+    return numViolations;
+}
+
+//=======================================new and delete===========================
+//The standard library routes the array, nothrow and sized forms through these four
+
+void* operator new(size_t size)
+{
+    report("operator new");
+
+    if (auto* ptr = rawAllocate(size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    report("operator new");
+
+    if (auto* ptr = rawAllocateAligned(size == 0 ? 1 : size, (size_t)alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        report("operator delete");
+
+    rawFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    if (ptr != nullptr)
+        report("operator delete");
+
+    rawFreeAligned(ptr);
+}
+
+//=======================================C allocator==============================
+#if JUCE_LINUX
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        report("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        report("calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        report("realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        report("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        report("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        report("posix_memalign");
+
+        if (alignment % sizeof(void*) != 0 || !juce::isPowerOfTwo(alignment))
+            return EINVAL;
+
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* ptr)
+    {
+        if (ptr != nullptr)
+            report("free");
+
+        __libc_free(ptr);
+    }
+}
+#endif
+
+//=======================================Locks====================================
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    using LockFunction = int (*)(pthread_mutex_t*);
+
+    //Constant initialised, so there's no guard variable that could take this very lock
+    static std::atomic<LockFunction> next{ nullptr };
+    auto function = next.load(std::memory_order_acquire);
+
+    if (function == nullptr)
+    {
+        function = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        next.store(function, std::memory_order_release);
+    }
+
+    report("pthread_mutex_lock");
+    return function(mutex);
+}
+#endif
+
+#endif
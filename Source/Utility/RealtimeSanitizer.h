@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    RealtimeSanitizer.h
+    Created: 17 Oct 2026 9:26:18pm
+    Author:  kylew
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_core/juce_core.h>
+
+//Opt-in guard for the audio thread, built with -DDISBURSER_RT_SANITIZER=ON.
+//
+//processBlock opens a Scope for its whole run. While one is open on a thread, the
+//sanitizer build replaces malloc, free, new, delete and pthread_mutex_lock with
+//versions that count the call and print it with a backtrace, once per distinct
+//call stack. The call itself still goes through, so a run shows every violation
+//rather than stopping at the first.
+//
+//Only executables can swap the allocator, so this is wired into the benchmark and
+//not the plugin formats, which live inside a host's process. malloc and free are
+//caught on Linux, locks on Linux and macOS, new and delete everywhere.
+//
+//Without the option a Scope is empty and compiles away.
+struct RealtimeSanitizer
+{
+   #if DISBURSER_RT_SANITIZER
+    struct Scope
+    {
+        Scope();
+        ~Scope();
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    //Every violation since startup, including repeats of a stack already printed
+    static int getNumViolations();
+   #else
+    struct Scope
+    {
+        Scope() {}
+    };
+
+    static int getNumViolations() { return 0; }
+   #endif
+
+    static constexpr bool isEnabled()
+    {
+       #if DISBURSER_RT_SANITIZER
+        return true;
+       #else
+        return false;
+       #endif
+    }
+};